@@ -1,9 +1,9 @@
 #include <chrono>
 #include <thread>
-#include <json.hpp>
 #include <fstream>
 
 #include "client.hh"
+#include "payload.hh"
 #include "repl-manager.hh"
 
 #define RESPONSE_WAIT_DURATION 40
@@ -71,12 +71,14 @@ replicate(Messenger& messenger,
   while (replicated == false) {
     connectToServer(messenger, serverConnection);
 
-    Message message;
-    nlohmann::json dataJson = {{"value", data}};
+    PayloadWriter writer;
+    writer.write(data);
 
-    std::string dataJsonString = dataJson.dump();
+    std::string payload;
+    writer.getData(payload);
 
-    messenger.setMessage(ClientCode::REPLICATE, dataJsonString, message);
+    Message message;
+    messenger.setMessage(ClientCode::REPLICATE, payload, message);
 
     messenger.send(0, message, serverConnection);
 
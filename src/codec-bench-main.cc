@@ -0,0 +1,92 @@
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+
+#include "payload.hh"
+
+#define DEFAULT_ITERATION_COUNT 200000
+#define VALUE_COUNT 8
+#define VALUE_SIZE 10
+
+// the payload of a PROPOSE message: a round id, a slot and a batch of values
+void
+encodePropose(const int64_t& roundId,
+              const int& slot,
+              const std::vector<std::string>& values,
+              std::string& data) {
+  PayloadWriter writer;
+  writer.write(roundId);
+  writer.write(slot);
+  writer.write(values);
+
+  writer.moveData(data);
+}
+
+bool
+decodePropose(const std::string& data,
+              int64_t& roundId,
+              int& slot,
+              std::vector<std::string>& values) {
+  PayloadReader reader(data);
+  reader.read(roundId);
+  reader.read(slot);
+  reader.read(values);
+
+  return reader.getIsValid();
+}
+
+int
+main(int argc, char* argv[]) {
+  int iterationCount = argc > 1 ? std::atoi(argv[1]) : DEFAULT_ITERATION_COUNT;
+  iterationCount = std::max(iterationCount, 1);
+
+  std::vector<std::string> values(VALUE_COUNT, std::string(VALUE_SIZE, 'x'));
+  std::vector<std::string> payloads(iterationCount);
+
+  auto encodeStart = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < iterationCount; i++) {
+    encodePropose(i, i * VALUE_COUNT, values, payloads[i]);
+  }
+
+  auto decodeStart = std::chrono::steady_clock::now();
+
+  // the decoded fields are summed so that the reads are not optimized out
+  int64_t checksum = 0;
+  for (int i = 0; i < iterationCount; i++) {
+    int64_t roundId;
+    int slot;
+    std::vector<std::string> decoded;
+
+    if (decodePropose(payloads[i], roundId, slot, decoded) == false) {
+      std::cerr << "invalid payload " << i << std::endl;
+      return 1;
+    }
+
+    checksum += roundId + slot + decoded.size();
+  }
+
+  auto decodeEnd = std::chrono::steady_clock::now();
+
+  auto encodeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      decodeStart - encodeStart)
+                      .count();
+  auto decodeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      decodeEnd - decodeStart)
+                      .count();
+
+#ifdef JSON_WIRE_FORMAT
+  std::cout << "format: json" << std::endl;
+#else
+  std::cout << "format: binary" << std::endl;
+#endif
+  std::cout << "payload bytes: " << payloads[0].size() << std::endl;
+  std::cout << "encode ns/op: " << encodeNs / iterationCount << std::endl;
+  std::cout << "decode ns/op: " << decodeNs / iterationCount << std::endl;
+  std::cout << "checksum: " << checksum << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,20 @@
+#include <fstream>
+
+#include "config.hh"
+
+#define SERVER_SECTION "server"
+
+void
+Config::load(const std::string& filePath) {
+  std::ifstream ifs(filePath);
+
+  if (ifs.good()) {
+    nlohmann::json json = nlohmann::json::parse(ifs, nullptr, false);
+
+    if (json.is_object() && json.contains(SERVER_SECTION)) {
+      m_json = json.at(SERVER_SECTION);
+    }
+  }
+
+  ifs.close();
+}
@@ -0,0 +1,51 @@
+/**
+ * @file   config.hh
+ * @author Otiose email
+ * @date   Sun Oct 18 14:02:17 2026
+ *
+ * @brief  Defines the Config class.
+ *
+ * This class gives access to the "server" section of the config file located
+ * in etc/config.json. Every setting has a default value used when either the
+ * file or the setting is missing, so that the server can run without any
+ * config file.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <json.hpp>
+
+class Config {
+public:
+  /**
+   * @brief Default Config constructor.
+   *
+   */
+  Config() = default;
+
+  /**
+   * @brief Reads the server settings from the given config file.
+   *
+   * @param[in] filePath path of the config file
+   */
+  void
+  load(const std::string& filePath);
+
+  /**
+   * @brief Gets the given setting.
+   *
+   * @param[in] key name of the setting
+   * @param[in] defaultValue value returned when the setting is not set
+   *
+   * @return value of the setting
+   */
+  template <typename T>
+  T
+  get(const std::string& key, const T& defaultValue) const;
+
+private:
+  nlohmann::json m_json = nlohmann::json::object();
+};
+
+#include "config.hxx"
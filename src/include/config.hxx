@@ -0,0 +1,5 @@
+template <typename T>
+T
+Config::get(const std::string& key, const T& defaultValue) const {
+  return m_json.value(key, defaultValue);
+}
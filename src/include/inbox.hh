@@ -0,0 +1,79 @@
+/**
+ * @file   inbox.hh
+ * @author Otiose email
+ * @date   Sun Oct 18 14:20:36 2026
+ *
+ * @brief  Defines the Inbox class.
+ *
+ * An Inbox is an unbounded single producer single consumer queue. It is used
+ * to hand the messages received by the dispatcher thread over to the receiver
+ * thread of their tag. Pushing and popping never take a lock, the mutex is
+ * only used to put the consumer to sleep while the inbox is empty.
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+template <typename T>
+class Inbox {
+public:
+  /**
+   * @brief Inbox constructor.
+   *
+   */
+  Inbox();
+
+  /**
+   * @brief Inbox destructor, frees the remaining items.
+   *
+   */
+  ~Inbox();
+
+  Inbox(const Inbox&) = delete;
+  Inbox&
+  operator=(const Inbox&) = delete;
+
+  /**
+   * @brief Pushes the given item, may only be called by the producer thread.
+   *
+   * @param[in] value item to push
+   */
+  void
+  push(T value);
+
+  /**
+   * @brief Pops the oldest item, may only be called by the consumer thread.
+   *
+   * @param[out] value item popped
+   *
+   * @return whether an item was popped
+   */
+  bool
+  tryPop(T& value);
+
+  /**
+   * @brief Blocks until an item can be popped.
+   *
+   * @param[out] value item popped
+   */
+  void
+  popBlock(T& value);
+
+private:
+  struct Node {
+    std::atomic<Node*> next = nullptr;
+    T value;
+  };
+
+  Node* m_head; /**< consumer side, always points to an already popped node */
+  Node* m_tail; /**< producer side */
+
+  std::atomic<bool> m_isWaiting = false;
+  std::mutex m_mutex;
+  std::condition_variable m_conditional;
+};
+
+#include "inbox.hxx"
@@ -0,0 +1,65 @@
+template <typename T>
+Inbox<T>::Inbox() {
+  m_head = new Node();
+  m_tail = m_head;
+}
+
+template <typename T>
+Inbox<T>::~Inbox() {
+  while (m_head != nullptr) {
+    Node* next = m_head->next.load();
+    delete m_head;
+    m_head = next;
+  }
+}
+
+template <typename T>
+void
+Inbox<T>::push(T value) {
+  Node* node = new Node();
+  node->value = std::move(value);
+
+  m_tail->next.store(node);
+  m_tail = node;
+
+  // the consumer announces itself before checking the inbox one last time, so
+  // either it sees the new node or the notification below is sent
+  if (m_isWaiting.load() == true) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_conditional.notify_one();
+  }
+}
+
+template <typename T>
+bool
+Inbox<T>::tryPop(T& value) {
+  Node* next = m_head->next.load();
+
+  bool popped = next != nullptr;
+
+  if (popped == true) {
+    value = std::move(next->value);
+
+    delete m_head;
+    m_head = next;
+  }
+
+  return popped;
+}
+
+template <typename T>
+void
+Inbox<T>::popBlock(T& value) {
+  if (this->tryPop(value) == false) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_isWaiting.store(true);
+
+    m_conditional.wait(lock, [&] { return m_head->next.load() != nullptr; });
+
+    m_isWaiting.store(false);
+
+    this->tryPop(value);
+  }
+}
@@ -7,12 +7,60 @@
  * 
  * This class ecapsulates all operations having to do with the log file of the 
  * given node.
+ *
+ * The log of a node is stored in the etc/server/log/NN directory as a list of
+ * segments. A segment file holds consecutive entries, each one framed by its
+ * size and CRC-32 checksum, and is named after the log index of its first
+ * entry. A new segment is started once the current one grows past a size
+ * threshold. Next to each segment an index file holds the offset of every
+ * LOG_INDEX_INTERVAL-th entry, so that an entry is found by reading at most
+ * that many record headers. On startup the tail of the last segment is checked
+ * and records torn by a crash are truncated.
+ *
+ * The last segment is kept open and appended entries are first copied to a
+ * buffer. The buffer is written to the file once it is full or when flush() is
+ * called, and sync() additionally waits for the file to reach the disk.
+ *
+ * How durable the appended entries are once commit() returns depends on the
+ * durability mode:
+ *
+ * - NONE: the entries are written to the file but not synced.
+ * - GROUP: the entries are synced. Threads committing while a sync is running
+ *   wait for it and share the next one.
+ * - PER_ENTRY: the entries are synced. Every commit runs its own sync, after
+ *   waiting for the running one, even if another one covered its entries.
+ *
+ * Syncs are run without holding the lock of the log, so appends go on during
+ * them.
+ *
+ * The log is never compacted: the replicated state is the list of the decided
+ * values itself, so no entry is ever superseded.
  * 
  */
 #pragma once
 
 #include <mutex>
 #include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "log-reader.hh"
+
+// a record is made of the size and checksum of the entry, each written as a
+// big-endian 32 bit integer, followed by the entry itself
+#define RECORD_HEADER_SIZE 8
+#define LOG_INDEX_INTERVAL 64
+
+enum class Durability { NONE = 0, GROUP = 1, PER_ENTRY = 2 };
+
+static std::unordered_map<std::string, Durability> const durabilityParseMap = {
+    {"none", Durability::NONE},
+    {"group", Durability::GROUP},
+    {"per-entry", Durability::PER_ENTRY}};
 
 class LogFileManager {
 public:
@@ -20,11 +68,19 @@ public:
    * @brief LogFileManager constructor.
    * 
    * @param[in] nodeId node id of the current node
+   * @param[in] durability durability of the committed entries
+   */
+  LogFileManager(const int& nodeId,
+                 const Durability& durability = Durability::NONE);
+
+  /** 
+   * @brief LogFileManager destructor, flushes and closes the log file.
+   * 
    */
-  LogFileManager(const int& nodeId);
+  ~LogFileManager();
 
   /** 
-   * @brief Appends a line with the given string to the log file.
+   * @brief Appends the given entry to the log buffer.
    * 
    * @param[in] entry string to append
    */
@@ -32,24 +88,171 @@ public:
   append(const std::string& entry);
 
   /** 
-   * @brief Replaces the contents of the log file with the given string.
+   * @brief Appends the given entries to the log buffer.
+   * 
+   * @param[in] entries strings to append
+   */
+  void
+  append(const std::vector<std::string>& entries);
+
+  /** 
+   * @brief Appends the given entries to the log buffer.
+   * 
+   * @param[in] entries views on the strings to append
+   */
+  void
+  append(const std::vector<std::string_view>& entries);
+
+  /** 
+   * @brief Maps the entries of the log in the given reader.
+   * 
+   * The log buffer is flushed beforehand.
+   * 
+   * @param[out] reader reader of the log
+   * 
+   * @return whether every segment was mapped
+   */
+  bool
+  openReader(LogReader& reader);
+
+  /** 
+   * @brief Reads the entry at the given log index.
+   * 
+   * @param[in] index log index of the entry
+   * @param[out] entry entry read
+   * 
+   * @return whether the entry exists and is intact
+   */
+  bool
+  readEntry(const int& index, std::string& entry);
+
+  /** 
+   * @brief Reads the entries from the given log index to the end of the log.
+   * 
+   * The log buffer is flushed beforehand.
+   * 
+   * @param[in] firstIndex log index of the first entry to read
+   * @param[in] count maximum number of entries to read
+   * @param[out] entries entries read
+   * 
+   * @return whether all the entries read are intact
+   */
+  bool
+  readEntries(const int& firstIndex,
+              const int& count,
+              std::vector<std::string>& entries);
+
+  /** 
+   * @brief Gets the checksum stored with the entry at the given log index.
+   * 
+   * Only the header of the record is read.
+   * 
+   * @param[in] index log index of the entry
+   * @param[out] checksum CRC-32 of the entry
+   * 
+   * @return whether the entry exists
+   */
+  bool
+  getChecksum(const int& index, uint32_t& checksum);
+
+  /** 
+   * @brief Removes the entries from the given log index to the end of the log.
+   * 
+   * @param[in] entryCount number of entries to keep
+   */
+  void
+  truncate(const int& entryCount);
+
+  /** 
+   * @brief Gets the number of entries in the log file.
+   * 
+   * Entries are indexed from 0 in the order they were appended. The index of
+   * the next appended entry is therefore the returned count.
+   * 
+   * @return number of entries
+   */
+  int
+  getEntryCount();
+
+  /** 
+   * @brief Measures the time taken to append an entry to the log directory.
+   * 
+   * A probe file is written and synced as the durability mode asks a few
+   * times, the median duration is returned.
+   * 
+   * @return append latency in microseconds
+   */
+  int64_t
+  measureAppendLatency();
+
+  /** 
+   * @brief Writes the log buffer to the log file.
+   * 
+   */
+  void
+  flush();
+
+  /** 
+   * @brief Writes the log buffer and waits for the log file to reach the disk.
    * 
-   * @param[in] contents new contents of the log file
    */
   void
-  replace(const std::string& contents);
+  sync();
 
   /** 
-   * @brief Reads the log file and stores the contents in the given string.
+   * @brief Makes the appended entries as durable as the durability mode asks.
    * 
-   * @param[out] contents contents of the log file
+   * This is the durability point of the log, it is called before an applied
+   * entry is acknowledged.
    */
   void
-  read(std::string& contents);
+  commit();
+
+  struct Segment {
+    int firstIndex = 0;    /**< log index of the first entry */
+    int entryCount = 0;    /**< number of entries */
+    uint64_t size = 0;     /**< size of the records, buffered ones included */
+    std::vector<uint64_t> offsets; /**< offsets of the indexed entries */
+    int readFd = -1;       /**< descriptor used for reads, opened on demand */
+  };
 
 private:
+  void
+  flushLocked();
+
+  void
+  groupSync(const bool& isShared);
+
+  void
+  appendLocked(const std::string_view& entry);
+
+  void
+  rollLocked(std::unique_lock<std::mutex>& lock);
+
+  void
+  openSegment(Segment& segment, const int& flags);
+
+  bool
+  readEntriesLocked(const int& firstIndex,
+                    const int& count,
+                    std::vector<std::string>& entries);
+
   int m_nodeId;
-  std::string m_logFilePath;
+  std::string m_logDirPath;
+  int m_entryCount = 0;
+
+  std::map<int, Segment> m_segments; /**< segments by log index */
+
+  int m_fd = -1;        /**< last segment */
+  int m_indexFd = -1;   /**< index of the last segment */
+  std::string m_buffer; /**< records not written to the segment yet */
+  std::string m_indexBuffer; /**< offsets not written to the index yet */
+
+  Durability m_durability;
+  uint64_t m_appendCount = 0;  /**< number of append calls */
+  uint64_t m_syncedCount = 0;  /**< append calls covered by the last sync */
+  bool m_isSyncing = false;    /**< whether a group sync is running */
+  std::condition_variable m_syncConditional;
 
   std::mutex m_mutex;
 };
@@ -0,0 +1,105 @@
+/**
+ * @file   log-reader.hh
+ * @author Otiose email
+ * @date   Sun Oct 18 17:41:09 2026
+ *
+ * @brief  Defines the LogReader class.
+ *
+ * A LogReader maps the segments of a log in memory and gives access to its
+ * entries as views on the mapping, so that large ranges of the log can be
+ * read without copying them. A reader is opened through
+ * LogFileManager::openReader() and sees the entries the log held at that
+ * time. The log must not be truncated or replaced while a reader is open.
+ *
+ */
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+class LogReader {
+public:
+  /**
+   * @brief Default LogReader constructor.
+   *
+   */
+  LogReader() = default;
+
+  /**
+   * @brief LogReader destructor, unmaps the segments.
+   *
+   */
+  ~LogReader();
+
+  LogReader(const LogReader&) = delete;
+  LogReader&
+  operator=(const LogReader&) = delete;
+
+  /**
+   * @brief Maps the given segment file.
+   *
+   * This function is meant to be used by LogFileManager::openReader().
+   *
+   * @param[in] path path of the segment file
+   * @param[in] firstIndex log index of the first entry of the segment
+   * @param[in] entryCount number of entries of the segment to map
+   * @param[in] size size of these entries in the segment file
+   * @param[in] offsets offsets of the indexed entries of the segment
+   *
+   * @return whether the segment was mapped
+   */
+  bool
+  mapSegment(const std::string& path,
+             const int& firstIndex,
+             const int& entryCount,
+             const uint64_t& size,
+             const std::vector<uint64_t>& offsets);
+
+  /**
+   * @brief Gets the entries from the given log index on.
+   *
+   * The views stay valid as long as the reader.
+   *
+   * @param[in] firstIndex log index of the first entry
+   * @param[in] count maximum number of entries
+   * @param[out] entries views on the entries
+   *
+   * @return whether all the entries are intact
+   */
+  bool
+  getEntries(const int& firstIndex,
+             const int& count,
+             std::vector<std::string_view>& entries) const;
+
+  /**
+   * @brief Gets the checksum stored with the entry at the given log index.
+   *
+   * @param[in] index log index of the entry
+   * @param[out] checksum CRC-32 of the entry
+   *
+   * @return whether the entry is mapped
+   */
+  bool
+  getChecksum(const int& index, uint32_t& checksum) const;
+
+  /**
+   * @brief Gets the number of mapped entries.
+   *
+   * @return log index following the last mapped entry
+   */
+  int
+  getEntryCount() const;
+
+  struct Mapping {
+    int entryCount;                /**< number of mapped entries */
+    const char* data;              /**< start of the mapping */
+    uint64_t size;                 /**< size of the mapping */
+    std::vector<uint64_t> offsets; /**< offsets of the indexed entries */
+  };
+
+private:
+  std::map<int, Mapping> m_mappings; /**< mappings by log index */
+};
@@ -8,12 +8,21 @@
  * This class encapsulates all client related calls. It derives from the
  * MessageReceiver class and handles messages with the MessageTag::CLIENT
  * tag.
+ *
+ * The REPLICATE requests are proposed in batches. The server serves one
+ * client connection at a time but keeps reading it while the batches are
+ * proposed, so the requests a client sends before its answers arrive share
+ * a batch. A request arriving while no batch is proposed is proposed at once,
+ * otherwise the requests arriving within the batch wait join it. A fixed pool
+ * of workers proposes the batches, one batch per worker at a time.
  * 
  */
 #pragma once
 
 #include <mutex>
+#include <condition_variable>
 #include <list>
+#include <vector>
 #include <thread>
 #include <string>
 
@@ -29,11 +38,17 @@ public:
    * 
    * @param[in] messenger node's messenger
    * @param[in] receiverManager receiver manager
+   * @param[in] batchWait milliseconds a batch waits for further requests
+   * @param[in] batchMaxSize number of requests of a batch
+   * @param[in] batchWorkerCount number of batches proposed at once
    * 
    * @return ClientManager instance
    */
   ClientManager(Messenger& messenger,
-                std::shared_ptr<ReceiverManager> receiverManager);
+                std::shared_ptr<ReceiverManager> receiverManager,
+                const int& batchWait,
+                const int& batchMaxSize,
+                const int& batchWorkerCount);
 
   /** 
    * @brief Starts the receiver
@@ -60,6 +75,25 @@ public:
    */
   void
   enableClientConn();
+
+  struct Request {
+    std::string value;                /**< value to replicate */
+    int srcNodeId;                    /**< node id of the client */
+    Messenger::Connection connection; /**< connection of the client */
+    int connectionId;                 /**< id of the connection */
+  };
+
+  struct Batch {
+    std::mutex mutex;
+    std::condition_variable conditional;
+    std::vector<Request> requests; /**< requests waiting to be proposed */
+    bool isUp = true;              /**< whether the workers run */
+    bool isGathering = false;      /**< whether a worker gathers a batch */
+    int connectionId = 0;          /**< id of the current client connection */
+    int inFlightCount = 0;         /**< batches being proposed */
+    int waitDuration = 0;          /**< milliseconds to wait for requests */
+    std::size_t maxSize = 1;       /**< requests of a batch */
+  };
 private:
   std::string m_port;
   std::string m_nextNodePort;
@@ -67,4 +101,7 @@ private:
   void receivePendingMessages();
 
   Messenger::Connection m_clientConnection;
+
+  Batch m_batch;
+  std::vector<std::thread> m_batchThreads;
 };
@@ -13,7 +13,11 @@
 #pragma once
 
 #include <string>
+#include <map>
+#include <vector>
 #include <mutex>
+#include <cstdint>
+#include <condition_variable>
 
 #include "messenger.hh"
 #include "message-receiver.hh"
@@ -30,14 +34,16 @@ public:
    * @param[in] messenger node's messenger
    * @param[in] receiverManager receiver manager
    * @param[in] logFileManager log file manager
+   * @param[in] windowSize number of proposals in flight at once
    * 
    * @return ConsensusManager instance
    */
   ConsensusManager(Messenger& messenger,
                    std::shared_ptr<ReceiverManager> receiverManager,
-                   LogFileManager& logFileManager);
+                   LogFileManager& logFileManager,
+                   const int& windowSize);
   /**
-   * @brief Start on consensus for the given value.
+   * @brief Start on consensus for the given batch of values.
    *
    *
    * Along with handleConsensusMessage() this function implements the Paxos
@@ -45,15 +51,63 @@ public:
    * https://en.wikipedia.org/wiki/Paxos_(computer_science) . This function is
    * only meant to be called by Proposer.
    *
+   * Each call decides the values of consecutive log slots with a single
+   * PROPOSE/ACCEPT exchange. Up to the window size given to the constructor
+   * calls can be in flight concurrently, in which case their slots are
+   * decided independently and applied to the log in order.
+   *
    * @param[in] messenger messenger of the current node
    * @param[in] nodeId node id of the current node
    * @param[in] clusterSize number of nodes in the cluster
-   * @param[in] value value get a consensus on
+   * @param[in] values values to get a consensus on
    */
   void
-  startConsensus(const std::string& value, 
+  startConsensus(const std::vector<std::string>& values,
                  bool& consensusReached);
 
+  /**
+   * @brief Runs phase 1 of Paxos once for all future consensus instances.
+   *
+   * This function is called by the node that just won an election. Once a
+   * majority promised the leader's round, startConsensus() only runs the
+   * PROPOSE/ACCEPT phase until the round is preempted (Multi-Paxos).
+   *
+   */
+  void
+  startLeadership();
+
+  /**
+   * @brief Stops proposing new values ahead of a leadership handover.
+   *
+   * Blocks until the values already proposed are decided or timed out, new
+   * proposals wait until resumeProposals() is called.
+   *
+   * @return size of the log once the proposed values are applied
+   */
+  int
+  pauseProposals();
+
+  /**
+   * @brief Resumes the proposals paused by pauseProposals().
+   *
+   * If the leadership was handed over the waiting proposals are dropped, as
+   * are the ones made afterwards.
+   *
+   * @param[in] isLeader whether the node kept the leadership
+   */
+  void
+  resumeProposals(const bool& isLeader);
+
+  /**
+   * @brief Waits for the log to hold the given number of entries.
+   *
+   * @param[in] entryCount number of entries
+   *
+   * @return whether the log holds them before the wait timed out
+   */
+  bool
+  waitForLog(const int& entryCount);
+
   /**
    * @brief Handles consensus related messages.
    *
@@ -72,16 +126,39 @@ public:
                 const Message& receivedMessage,
                 const Messenger::Connection& connection) final;
 
+  struct Instance {
+    int64_t roundId = -1; /**< round under which the values were proposed */
+    std::vector<std::string> values; /**< values of consecutive slots */
+    int acceptCount = 0;    /**< number of accepts, the proposer included */
+    bool isDecided = false; /**< whether a majority accepted the values */
+  };
+
+  struct AcceptedValue {
+    int64_t acceptedId = -1; /**< round in which the value was accepted */
+    std::string value = "";  /**< accepted value */
+  };
+
   struct Context {
     Context() = default;
 
-    int roundId = -1;               /**< id of the current consensus round */
-    int maxAcceptedId = -1;         /**< max id found in promise responses */
-    bool valueAccepted = false;     /**< whether a value was accepted */
-    int acceptedId = -1;            /**< id of the associated accepted round */
-    std::string acceptedValue = ""; /**< value of the associated accepted id */
-    int promiseCount = 0; /**< number of promises received this round */
-    int acceptCount = 0;  /**< number of accepts received this round */
+    // proposer
+    int64_t roundId = -1;       /**< id of the last prepared round */
+    int promiseCount = 0;       /**< promises for roundId, own one included */
+    int64_t leaderRoundId = -1; /**< round promised by a majority, -1 if none */
+    bool isPreparing = false;   /**< whether phase 1 is currently running */
+    int nextSlot = 0;           /**< next log slot to propose into */
+    bool isPaused = false;      /**< whether proposals wait for a handover */
+    bool isRetired = false;     /**< whether the leadership was handed over */
+    int windowSize = 1;         /**< proposals allowed in flight at once */
+    std::map<int, AcceptedValue> recovered; /**< values found in promises */
+    std::map<int, Instance> instances;      /**< in-flight instances */
+
+    // acceptor
+    int64_t maxRoundId = -1;               /**< highest promised round */
+    std::map<int, AcceptedValue> accepted; /**< accepted values by slot */
+
+    // learner
+    std::map<int, std::string> decided; /**< decided but unapplied values */
   };
 
   /** 
@@ -95,7 +172,6 @@ private:
   LogFileManager& m_logFileManager;
 
   std::mutex m_mutex;
+  std::condition_variable m_quorumConditional;
   Context m_context;
-
-  int m_maxRoundId = -1;
 };
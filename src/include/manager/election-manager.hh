@@ -9,11 +9,45 @@
  * MessageReceiver class and handles messages with the
  * MessageTag::LEADER_ELECTION tag.
  *
+ * A single thread waits for the outcome of an election. It sleeps on a
+ * condition variable until either the victory of a node wakes it up or the
+ * deadline of the election passes. An answer from a higher node pushes the
+ * deadline back.
+ *
+ * With the ElectionMode::RAFT mode the bully algorithm is replaced by a term
+ * based election. A node which does not hear of a leader before a randomized
+ * timeout starts a new term and asks every node for its vote, each node votes
+ * once per term and a majority of votes elects the leader of the term. A node
+ * ignores the requests for votes as long as it knows of a leader, which it
+ * only drops once its failure detection suspects it.
+ *
+ * As the leader carries most of the load, the nodes are ranked by a capability
+ * score rather than by their id alone. The score of a node is measured once at
+ * startup from the class of its cpu, the latency of an append to its log and
+ * its round trip time to the other nodes. The round trips are probed again
+ * until a round is answered by every node, so that a node which started late
+ * is not charged for its startup. With the bully algorithm the node
+ * with the highest score wins, with the raft mode the nodes with the highest
+ * scores time out first and a node only votes for nodes scoring higher than
+ * itself. The node id breaks ties.
+ *
+ * The leadership can also be handed over on purpose, e.g. before the
+ * maintenance of the leader. The leader stops proposing, then asks the target
+ * to take over. As soon as its log holds every entry of the log of the leader
+ * the target asks the leader for a go ahead. The leader only gives it while it
+ * still waits for the target and steps down as it does, the target declares
+ * its victory once it receives it. A leader which stopped waiting resumes its
+ * proposals and ignores the target, so that both never lead at once. No failure has to be detected, so
+ * the handover only takes a few round trips.
+ *
  */
 #pragma once
 
 #include <mutex>
 #include <chrono>
+#include <condition_variable>
+#include <unordered_map>
+#include <vector>
 
 #include "message-receiver.hh"
 #include "messenger.hh"
@@ -21,6 +55,11 @@
 
 using timePoint = std::chrono::time_point<std::chrono::high_resolution_clock>;
 
+enum class ElectionMode { BULLY = 0, RAFT = 1 };
+
+static std::unordered_map<std::string, ElectionMode> const electionParseMap = {
+    {"bully", ElectionMode::BULLY}, {"raft", ElectionMode::RAFT}};
+
 class ElectionManager : public MessageReceiver {
 public:
   inline static MessageTag managedTag = MessageTag::LEADER_ELECTION;
@@ -30,11 +69,17 @@ public:
    * 
    * @param[in] messenger node's messenger
    * @param[in] receiverManager receiver manager
+   * @param[in] mode election algorithm
+   * @param[in] cpuClass relative speed of the cpu of the node
+   * @param[in] appendLatency latency of an append to the log in microseconds
    * 
    * @return ElectionManager instance
    */
   ElectionManager(Messenger& messenger,
-                  std::shared_ptr<ReceiverManager> receiverManager);
+                  std::shared_ptr<ReceiverManager> receiverManager,
+                  const ElectionMode& mode,
+                  const int& cpuClass,
+                  const int64_t& appendLatency);
 
   /**
    * @brief Handles messages tagged for leader election.
@@ -76,14 +121,49 @@ public:
   void
   startElection();
 
+  /**
+   * @brief Hands the leadership of this node over to the given node.
+   *
+   * Only the leader hands its leadership over. It stops proposing new values
+   * and waits for the proposed ones to be decided, the given node takes over
+   * once its log holds all of them. The leader resumes its proposals if the
+   * node did not take over in time.
+   *
+   * @param[in] dstNodeId id of the node taking the leadership over
+   *
+   * @return whether the given node took the leadership over
+   */
+  bool
+  transferLeadership(const int& dstNodeId);
+
+  struct Context {
+    std::mutex mutex;
+    std::condition_variable conditional;
+    int leaderNodeId = -1;      /**< elected leader, -1 during an election */
+    bool aliveReceived = false; /**< whether a higher node answered */
+    bool isElecting = false;    /**< whether a thread waits for the outcome */
+    timePoint deadline;         /**< end of the current wait */
+    int64_t term = 0;           /**< latest term known to the node */
+    int votedFor = -1;          /**< node voted for during the term */
+    int voteCount = 0;          /**< votes received as a candidate */
+    std::vector<int64_t> scores; /**< capability scores by node id */
+    timePoint probeStart;        /**< time the round trip probe was sent */
+    int probeRound = -1;         /**< round of the round trip probe */
+    int probeCount = 0;          /**< answers to the round trip probe */
+    std::vector<int64_t> roundTrips; /**< shortest round trips in microseconds
+                                        by node id, -1 until it answered */
+    int transferNodeId = -1;     /**< node taking the leadership over */
+    int64_t handoverId = -1;     /**< handover offered to transferNodeId */
+    int64_t takeOverId = -1;     /**< last handover the leader let through */
+  };
+
 private:
   void
   init() final;
 
-  std::mutex m_mutex;
-
-  int m_leaderNodeId = -1;
-  bool m_aliveReceived = false;
+  ElectionMode m_mode;
+  int m_cpuClass;
+  int64_t m_appendLatency;
 
-  timePoint m_start;
+  Context m_context;
 };
@@ -9,12 +9,37 @@
  * MessageReceiver class and handles messages with the
  * MessageTag::FAILURE_DETECTION tag.
  *
+ * The leader recovers several nodes at once, up to the given number of
+ * recoveries. Every recovery round is tracked in the slot of its node and the
+ * rounds pause the client manager together for their last entries.
+ *
+ * Failures are detected with a phi accrual detector. Every node keeps the
+ * latest intervals between the pings of each other node, the suspicion of a
+ * node is the improbability of its next ping arriving this late given the mean
+ * and deviation of these intervals. A node is deemed failed once its suspicion
+ * exceeds the given threshold, so the detection adapts to the jitter of each
+ * link rather than waiting for a fixed timeout.
+ *
+ * With the FailureDetection::SWIM mode the nodes no longer ping every other
+ * node. In every protocol period a node probes a single member, picked in turn
+ * from a shuffled list. If the member does not answer in time a few other
+ * members are asked to probe it, and if none of them gets an answer either the
+ * member is suspected. A suspected member which does not refute the suspicion
+ * with a newer incarnation is deemed failed. The changes of membership are
+ * piggybacked on the probes and their answers, so that every node sends a
+ * constant number of messages per period whatever the size of the cluster.
+ *
  */
 #pragma once
 
 #include <vector>
+#include <deque>
+#include <map>
 #include <chrono>
 #include <thread>
+#include <shared_mutex>
+#include <condition_variable>
+#include <unordered_map>
 #include <condition_variable>
 
 #include "message-receiver.hh"
@@ -24,6 +49,14 @@
 
 using timePoint = std::chrono::time_point<std::chrono::high_resolution_clock>;
 
+enum class FailureDetection { HEARTBEAT = 0, SWIM = 1 };
+
+static std::unordered_map<std::string, FailureDetection> const
+    failureDetectionParseMap = {{"heartbeat", FailureDetection::HEARTBEAT},
+                                {"swim", FailureDetection::SWIM}};
+
+enum class MemberState { ALIVE = 0, SUSPECT = 1, FAILED = 2 };
+
 class FailureManager : public MessageReceiver {
 public:
   inline static MessageTag managedTag = MessageTag::FAILURE_DETECTION;
@@ -34,12 +67,18 @@ public:
    * @param[in] messenger node's messenger
    * @param[in] receiverManager receiver manager
    * @param[in] logFileManager log file manager
+   * @param[in] maxRecoveryCount number of nodes recovered at once
+   * @param[in] phiThreshold suspicion from which a node is deemed failed
+   * @param[in] detection failure detection protocol
    * 
    * @return FailureManager instance.
    */
   FailureManager(Messenger& messenger,
                  std::shared_ptr<ReceiverManager> receiverManager,
-                 LogFileManager& logFileManager);
+                 LogFileManager& logFileManager,
+                 const int& maxRecoveryCount,
+                 const double& phiThreshold,
+                 const FailureDetection& detection);
 
   /** 
    * @brief Handles failure related messages
@@ -79,13 +118,42 @@ public:
   void
   disallowRecovery();
 
+  struct ArrivalWindow {
+    std::deque<int64_t> intervals; /**< latest ping intervals in microseconds */
+    int64_t sum = 0;               /**< sum of the intervals */
+    int64_t squareSum = 0;         /**< sum of the squared intervals */
+  };
+
+  struct Member {
+    MemberState state = MemberState::ALIVE; /**< state of the member */
+    int64_t incarnation = 0; /**< incarnation the state applies to */
+    timePoint suspectTime;   /**< time the member was suspected */
+  };
+
+  struct Update {
+    MemberState state = MemberState::ALIVE; /**< state to gossip */
+    int64_t incarnation = 0;                /**< incarnation of the state */
+    int sendCount = 0; /**< number of messages the update was sent with */
+  };
+
   struct Context {
     std::mutex mutex; // TODO rename to nodeStateMutex
     std::vector<timePoint> timeStamps;
     std::vector<bool> isAlive;
-    int curRecoveryId = -1;
-    std::mutex curRecoveryIdMutex;
-    std::mutex clientConnMutex;
+    std::vector<ArrivalWindow> arrivalWindows; /**< ping intervals by index */
+    double phiThreshold = 8;                   /**< suspicion of a failure */
+    FailureDetection detection = FailureDetection::HEARTBEAT;
+    std::vector<Member> members;   /**< swim membership by node id */
+    std::map<int, Update> updates; /**< updates to gossip by node id */
+    int64_t probeSeq = 0;          /**< sequence number of the last probe */
+    bool isAcked = false;          /**< whether the last probe was answered */
+    std::vector<int64_t> recoveryIds; /**< recovery round by node index */
+    std::vector<int64_t> updatedIds;  /**< last round the node completed */
+    int recoveryCount = 0;            /**< recovery rounds in progress */
+    int maxRecoveryCount = 1;         /**< recovery rounds allowed at once */
+    std::mutex recoveryMutex;
+    std::condition_variable recoveryConditional;
+    std::shared_mutex clientConnMutex;
     bool allowRecovery = true;
   };
 
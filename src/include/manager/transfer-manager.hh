@@ -0,0 +1,148 @@
+/**
+ * @file   transfer-manager.hh
+ * @author Otiose email
+ * @date   Sun Oct 18 19:02:37 2026
+ *
+ * @brief  Declares the TransferManager class.
+ *
+ * This class streams the log of the leader to recovering nodes. It derives
+ * from the MessageReceiver class and handles messages with the
+ * MessageTag::STATE_TRANSFER tag, so that large transfers do not delay the
+ * heartbeats of the failure detection tag.
+ *
+ * The entries are sent in chunks of bounded size. The leader only keeps a
+ * window of unacknowledged chunks in flight, every chunk applied by the
+ * recovering node is acknowledged with the size of its log. When the
+ * acknowledgements stop the leader resends the chunks from the last
+ * acknowledged entry. As every chunk is committed when applied, a transfer
+ * interrupted by a failure resumes from the entries already received during
+ * the next recovery round.
+ *
+ * The leader can hand the chunks of the bulk of the log over to up to date
+ * followers, which send them to the recovering node in its place. The leader
+ * gives the checksum of every forwarded chunk, so the recovering node only
+ * applies entries matching the log of the leader. As the chunks of different
+ * senders overtake each other, the chunks received ahead of the log are kept
+ * until the missing ones are applied.
+ *
+ */
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <map>
+#include <vector>
+
+#include "message-receiver.hh"
+#include "messenger.hh"
+#include "log-file-manager.hh"
+
+class TransferManager : public MessageReceiver {
+public:
+  inline static MessageTag managedTag = MessageTag::STATE_TRANSFER;
+
+  /**
+   * @brief TransferManager constructor.
+   *
+   * @param[in] messenger node's messenger
+   * @param[in] receiverManager receiver manager
+   * @param[in] logFileManager log file manager
+   *
+   * @return TransferManager instance.
+   */
+  TransferManager(Messenger& messenger,
+                  std::shared_ptr<ReceiverManager> receiverManager,
+                  LogFileManager& logFileManager);
+
+  /**
+   * @brief Handles state transfer messages.
+   *
+   * @param[in] srcNodeId node id from which the message originated
+   * @param[in] receivedMessage message received
+   * @param[in] connection connection from which it was received
+   */
+  void
+  handleMessage(const int& srcNodeId,
+                const Message& receivedMessage,
+                const Messenger::Connection& connection) final;
+
+  /**
+   * @brief Stops the receiver.
+   *
+   */
+  void
+  stopReceiver() final;
+
+  /**
+   * @brief Opens a stream of the log to the given node.
+   *
+   * @param[in] dstNodeId id of the recovering node
+   * @param[in] recoveryId id of the recovery round
+   * @param[in] firstIndex log index from which the logs of both nodes differ
+   */
+  void
+  openStream(const int& dstNodeId,
+             const int64_t& recoveryId,
+             const int& firstIndex);
+
+  /**
+   * @brief Streams the log to the given node until it acknowledged all of it.
+   *
+   * Blocks until the stream of the given recovery round is opened, then sends
+   * the entries the log holds, including the ones appended while streaming.
+   * The last chunk is flagged when the caller guarantees that no entries will
+   * be appended anymore.
+   *
+   * The chunks are forwarded in turn to the given nodes, the leader only sends
+   * the latest entries itself. If a chunk is not acknowledged the leader sends
+   * the rest of the log itself.
+   *
+   * @param[in] dstNodeId id of the recovering node
+   * @param[in] recoveryId id of the recovery round
+   * @param[in] isLast whether the recovering node must complete its recovery
+   * @param[in] sourceNodeIds ids of the up to date nodes serving the chunks
+   *
+   * @return whether the node acknowledged the whole log
+   */
+  bool
+  sendState(const int& dstNodeId,
+            const int64_t& recoveryId,
+            const bool& isLast,
+            const std::vector<int>& sourceNodeIds);
+
+  /**
+   * @brief Closes the stream to the given node.
+   *
+   * @param[in] dstNodeId id of the recovering node
+   */
+  void
+  closeStream(const int& dstNodeId);
+
+  struct Stream {
+    int64_t recoveryId = -1; /**< id of the recovery round */
+    int baseIndex = 0;       /**< log index from which the logs differ */
+    int sentCount = 0;       /**< log index following the last sent entry */
+    int ackedCount = 0;      /**< log size acknowledged by the node */
+    int inFlightCount = 0;   /**< chunks sent and not acknowledged yet */
+    bool isComplete = false; /**< whether the node completed its recovery */
+    int forwardCount = 0;     /**< chunks forwarded to other nodes */
+    bool isForwarding = true; /**< whether chunks are forwarded */
+  };
+
+  struct Chunk {
+    int ackNodeId = 0;               /**< node acknowledging the chunk */
+    bool isLast = false;             /**< whether the chunk ends the log */
+    std::vector<std::string> entries; /**< entries of the chunk */
+  };
+
+private:
+  LogFileManager& m_logFileManager;
+
+  std::mutex m_mutex;
+  std::condition_variable m_conditional;
+  std::unordered_map<int, Stream> m_streams; /**< streams by node id */
+
+  int64_t m_appliedRecoveryId = -1; /**< recovery round of the applied chunks */
+  std::map<int, Chunk> m_pendingChunks; /**< chunks ahead of the log by index */
+};
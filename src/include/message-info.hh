@@ -19,14 +19,23 @@ enum class MessageTag {
   REPL = 2,
   FAILURE_DETECTION = 3,
   CLIENT = 4,
-  SIZE = 5
+  STATE_TRANSFER = 5,
+  SIZE = 6
 };
 
 enum class LeaderElectionCode {
   SHUTDOWN = 0,
   ELECTION = 1,
   ALIVE = 2,
-  VICTORY = 3
+  VICTORY = 3,
+  REQUEST_VOTE = 4,
+  VOTE = 5,
+  PROBE = 6,
+  PROBE_ACK = 7,
+  TRANSFER = 8,
+  HANDOVER = 9,
+  TAKE_OVER = 10,
+  TAKE_OVER_ACK = 11
 };
 
 enum class ConsensusCode {
@@ -41,9 +50,13 @@ enum class ConsensusCode {
 enum class FailureCode {
   SHUTDOWN = 0,
   PING = 1,
-  STATE = 2,
-  STATE_UPDATED = 3,
-  RECOVERED = 4
+  STATE_UPDATED = 2,
+  RECOVERED = 3,
+  SYNC = 4,
+  SYNC_INFO = 5,
+  PROBE = 6,
+  PROBE_REQ = 7,
+  ACK = 8
 };
 
 enum class ClientCode {
@@ -51,7 +64,15 @@ enum class ClientCode {
   PORT = 1,
   DISCONNECT = 2,
   REPLICATE = 3,
-  SUCCESS = 4
+  SUCCESS = 4,
+  NOT_LEADER = 5
+};
+
+enum class TransferCode {
+  SHUTDOWN = 0,
+  CHUNK = 1,
+  ACK = 2,
+  FORWARD = 3
 };
 
 enum class ReplCode {
@@ -61,7 +82,8 @@ enum class ReplCode {
   SPEED_MEDIUM = 3,
   SPEED_HIGH = 4,
   CRASH = 5,
-  RECOVER = 6
+  RECOVER = 6,
+  TRANSFER_LEADER = 7
 };
 
 static std::unordered_map<std::string, ReplCode> const replParseMap = {
@@ -71,7 +93,8 @@ static std::unordered_map<std::string, ReplCode> const replParseMap = {
     {"speed-medium", ReplCode::SPEED_MEDIUM},
     {"speed-high", ReplCode::SPEED_HIGH},
     {"crash", ReplCode::CRASH},
-    {"recover", ReplCode::RECOVER}};
+    {"recover", ReplCode::RECOVER},
+    {"transfer-leader", ReplCode::TRANSFER_LEADER}};
 
 template <typename T>
 MessageTag
@@ -80,19 +103,39 @@ getTagFromCode();
 namespace print {
 
 static std::vector<std::string> const messageTagMap = {
-    "ELECTION", "CONSENSUS", "REPL", "FAILURE", "CLIENT"};
-
-static std::vector<std::string> const electionMap = {
-    "SHUTDOWN", "ELECTION", "ALIVE", "VICTORY"};
+    "ELECTION", "CONSENSUS", "REPL", "FAILURE", "CLIENT", "TRANSFER"};
+
+static std::vector<std::string> const electionMap = {"SHUTDOWN",
+                                                   "ELECTION",
+                                                   "ALIVE",
+                                                   "VICTORY",
+                                                   "REQ_VOTE",
+                                                   "VOTE",
+                                                   "PROBE",
+                                                   "PROBE_ACK",
+                                                   "TRANSFER",
+                                                   "HANDOVER",
+                                                   "TAKE_OVER",
+                                                   "TKOVR_ACK"};
 
 static std::vector<std::string> const consensusMap = {
     "SHUTDOWN", "PREPARE", "PROMISE", "PROPOSE", "ACCEPT", "ACCEPTED"};
 
-static std::vector<std::string> const failureMap = {
-    "SHUTDOWN", "PING", "STATE", "STATE_UPDT", "RECOVERED"};
+static std::vector<std::string> const failureMap = {"SHUTDOWN",
+                                                    "PING",
+                                                    "STATE_UPDT",
+                                                    "RECOVERED",
+                                                    "SYNC",
+                                                    "SYNC_INFO",
+                                                    "PROBE",
+                                                    "PROBE_REQ",
+                                                    "ACK"};
 
 static std::vector<std::string> const clientMap = {
-    "SHUTDOWN", "PORT", "DISCONNECT", "REPLICATE", "SUCCESS"};
+    "SHUTDOWN", "PORT", "DISCONNECT", "REPLICATE", "SUCCESS", "NOT_LEADER"};
+
+static std::vector<std::string> const transferMap = {
+    "SHUTDOWN", "CHUNK", "ACK", "FORWARD"};
 
 static std::vector<std::string> const replMap = {"SHUTDOWN",
                                                  "START",
@@ -100,10 +143,11 @@ static std::vector<std::string> const replMap = {"SHUTDOWN",
                                                  "SPEED_MDIM",
                                                  "SPEED_HIGH",
                                                  "CRASH",
-                                                 "RECOVER"};
+                                                 "RECOVER",
+                                                 "TRANSFER_LD"};
 
 static std::vector<std::vector<std::string>> const codeMap = {
-    electionMap, consensusMap, replMap, failureMap, clientMap};
+    electionMap, consensusMap, replMap, failureMap, clientMap, transferMap};
 
 static void
 printString(const int& srcNodeId, const std::string& str) {
@@ -117,7 +161,8 @@ printSentMessage(const int& srcNodeId,
                  const int& tag,
                  const int& code) {
 
-  if (!(tag == 3 && code == 1)) {
+  // the periodic failure detection messages are not printed
+  if (!(tag == 3 && (code == 1 || code == 6 || code == 8))) {
     std::cout << std::setfill('-') << std::left << "[" << srcNodeId << "]"
               << "[" << dstNodeId << "]"
               << "[" << std::setw(10) << messageTagMap[tag] << "]"
@@ -7,7 +7,7 @@
  *
  * The MessageReceiver class is a pure virtual class which handles all logic
  * related to receiving and handling messages of a given tag. It is currently
- * derived by the 5 message tag managers located in src/manager.
+ * derived by the 6 message tag managers located in src/manager.
  *
  */
 #pragma once
@@ -15,11 +15,17 @@
 #include "message-info.hh"
 #include "messenger.hh"
 #include "message.hh"
+#include "inbox.hh"
 
 class ReceiverManager;
 
 class MessageReceiver {
 public:
+  struct Delivery {
+    int srcNodeId;   /**< node id from which the message originated */
+    Message message; /**< message received */
+  };
+
   /**
    * @brief MessageReceiver contructor
    *
@@ -50,6 +56,29 @@ public:
                 const Message& receivedMessage,
                 const Messenger::Connection& connection = {MPI_COMM_WORLD}) = 0;
 
+  /**
+   * @brief Blocks until a message of the receiver's tag is received.
+   *
+   * When the node runs a dispatcher the message is popped from the receiver's
+   * inbox, otherwise it is received from the messenger directly.
+   *
+   * @param[out] srcNodeId node id from which the message was received
+   * @param[out] message message received
+   */
+  void
+  receiveMessage(int& srcNodeId, Message& message);
+
+  /**
+   * @brief Hands a message over to the receiver.
+   *
+   * This function is only called by the dispatcher thread.
+   *
+   * @param[in] srcNodeId node id from which the message originated
+   * @param[in] message message received, moved to the inbox
+   */
+  void
+  deliverMessage(const int& srcNodeId, Message&& message);
+
   /**
    * @brief Stops the receiving loop
    *
@@ -66,4 +95,6 @@ protected:
   Messenger& m_messenger;
 
   MessageTag m_tag;
+
+  Inbox<Delivery> m_inbox;
 };
@@ -14,6 +14,7 @@
 
 #include <string>
 #include <memory>
+#include <cstdint>
 
 #include "message-info.hh"
 
@@ -46,9 +47,33 @@ public:
   Message(const MessagePassKey&,
           const int& tag,
           const int& code,
-          const int& id,
+          const int64_t& id,
           const std::shared_ptr<std::string>& data);
 
+  /**
+   * @brief Copy constructor for the Message class, the data is shared.
+   *
+   * @param other message instance from which to copy
+   */
+  Message(const Message& other) = default;
+
+  /**
+   * @brief Move constructor for the Message class.
+   *
+   * @param other message instance from which to move
+   */
+  Message(Message&& other) = default;
+
+  /**
+   * @brief Move assignment operator for the Message class.
+   *
+   * @param other message instance from which to move
+   *
+   * @return assigned Message
+   */
+  Message&
+  operator=(Message&& other) = default;
+
   /**
    * @brief Copy constructor for the Message class.
    *
@@ -97,7 +122,7 @@ public:
    *
    * @return message's id
    */
-  int
+  int64_t
   getId() const;
 
   /**
@@ -115,6 +140,13 @@ public:
   void
   setData(const std::string&);
 
+  /**
+   * @brief Sets the data field of the message without copying it.
+   *
+   */
+  void
+  setData(std::string&&);
+
   /**
    * @brief returns whether the message was properly initialized.
    *
@@ -129,7 +161,7 @@ public:
 private:
   int m_tag;
   int m_code;
-  int m_id;
+  int64_t m_id;
   std::shared_ptr<std::string> m_data;
 
   bool m_isValid = false;
@@ -15,6 +15,11 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
 
 #include "message.hh"
 #include "message-info.hh"
@@ -27,6 +32,14 @@ public:
     MPI_Comm connection;
   };
 
+  struct SendQueue {
+    std::mutex mutex;
+    std::condition_variable conditional;
+    std::vector<MPI_Request> requests; /**< pending nonblocking sends */
+    std::vector<std::shared_ptr<std::string>> buffers; /**< their buffers */
+    bool isUp = true; /**< whether the progress thread runs */
+  };
+
   /**
    * @brief Default Messenger construct.
    *
@@ -39,18 +52,25 @@ public:
    * This function calls MPI_init() and queries the rank of the current process
    * and the size of the current universe.
    *
+   * Pending sends are completed by a dedicated progress thread unless
+   * useProgressThread is false, in which case the caller is expected to call
+   * progressSends() regularly.
+   *
    * @param[out] rank rank of the process.
    * @param[out] clusterSize number of processes in the cluster.
+   * @param[in] useProgressThread whether to start the progress thread
    */
   void
-  start(int argc, char** argv);
+  start(int argc, char** argv, const bool& useProgressThread = true);
 
   /**
    * @brief Stops the MPI API by calling MPI_Finalize().
    *
+   * All pending sends are completed beforehand.
+   *
    */
   void
-  stop() const;
+  stop();
 
   /**
    * @brief Gets the rank of the current process.
@@ -75,6 +95,13 @@ public:
    * This function initializes messages with additional information useful
    * during communication.
    *
+   * Each message gets a unique 64 bit id made of a hybrid logical clock in its
+   * high bits and the rank of the node in its low bits. The clock follows the
+   * wall clock in milliseconds and is moved past the id of every message
+   * received, so ids are strictly increasing on a node, never shared by two
+   * nodes and greater than any id the node has seen. They are used as ballots
+   * by the consensus.
+   *
    * @param code message code
    * @param message message to initialize
    */
@@ -96,6 +123,9 @@ public:
   /**
    * @brief Sends the given message to the specified node.
    *
+   * The send is nonblocking. The serialized message is kept alive until the
+   * progress thread sees the send complete.
+   *
    * @param[in] dstNodeId destination node.
    * @param[in] message message to send.
    */
@@ -107,6 +137,9 @@ public:
   /** 
    * @brief Send the given message to all nodes in the given range.
    * 
+   * The message is serialized once and the same buffer is shared by the
+   * nonblocking sends to every node.
+   * 
    * @param[in] message message to send
    * @param start start node id
    * @param end end node id (included)
@@ -137,6 +170,10 @@ public:
    * An std::optional was not used for the sake of simplicity. The function
    * might be refactored if necessary.
    *
+   * The message is matched once by MPI_Improbe and received through its
+   * handle, so a concurrent receive on the same tag cannot take it in between.
+   * A matched message from a node considered dead is received and discarded.
+   *
    * @param[in] messageTag messsage tag.
    * @param[out] messageReceived whether a message was received.
    * @param[out] srcNodeId node id from which the message originated.
@@ -149,6 +186,27 @@ public:
                  Message& message,
                  const Connection& connection = {MPI_COMM_WORLD}) const;
 
+  /**
+   * @brief Receives a pending message of any tag from the cluster.
+   *
+   * Messages from nodes considered dead are dropped the same way as in
+   * receiveWithTag().
+   *
+   * @param[out] messageReceived whether a message was received.
+   * @param[out] srcNodeId node id from which the message originated.
+   * @param[out] message optional message received.
+   */
+  void
+  receiveAnyTag(bool& messageReceived, int& srcNodeId, Message& message) const;
+
+  /**
+   * @brief Tests the pending sends once and releases the completed ones.
+   *
+   * @return whether sends are still pending
+   */
+  bool
+  progressSends();
+
   /** 
    * @brief Opens the given port for communication.
    * 
@@ -230,14 +288,38 @@ public:
   setNodeStatus(const int& nodeId, const bool& isAlive);
 
 private:
+  /**
+   * @brief Generates an id greater than all the ids generated or observed.
+   *
+   * Ids are positive until 2089, the range of the milliseconds counted from
+   * 2020 in the 41 bits left above the counter and the rank.
+   *
+   * @param[in] nodeId rank of the node generating the id
+   * @param[out] id generated id
+   */
+  void
+  generateUniqueId(const int& nodeId, int64_t& id) const;
+
   void
-  generateUniqueId(const int& nodeId, int& id) const;
+  observeId(const Message& message) const;
+
+  void
+  postSend(const int& dstNodeId,
+           const Message& message,
+           const std::shared_ptr<std::string>& buffer,
+           const Connection& connection) const;
 
   int m_rank;
   int m_clusterSize;
 
   std::mutex m_mutex;
   std::vector<bool> m_processIsAlive;
+
+  mutable SendQueue m_sendQueue;
+  std::thread m_progressThread;
+  std::vector<int> m_sendIndices;
+
+  mutable std::atomic<int64_t> m_clock = 0; /**< hybrid logical clock */
 };
 
 #include "messenger.hxx"
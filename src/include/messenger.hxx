@@ -6,7 +6,7 @@ Messenger::setMessage(const T& code,
   MessagePassKey passKey;
   int tag = static_cast<int>(getTagFromCode<T>());
   int codeInt = static_cast<int>(code);
-  int id;
+  int64_t id;
   this->generateUniqueId(m_rank, id);
   std::shared_ptr<std::string> dataPtr = std::make_shared<std::string>(data);
 
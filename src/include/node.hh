@@ -40,7 +40,7 @@ public:
    * 
    */
   void
-  destroy() const;
+  destroy();
 
 private:
   std::shared_ptr<ReceiverManager> m_receiverManager;
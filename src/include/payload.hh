@@ -0,0 +1,232 @@
+/**
+ * @file   payload.hh
+ * @author Otiose email
+ * @date   Sun Oct 18 10:12:44 2026
+ *
+ * @brief  Defines the PayloadWriter and PayloadReader classes.
+ *
+ * These classes encode and decode the data field of messages. Values are
+ * written one after the other and must be read back in the same order.
+ * Integers are written in big-endian order so that nodes of different cpu
+ * architectures can communicate. When the project is built with the
+ * JSON_WIRE_FORMAT option the values are written as a json array instead,
+ * which makes the messages human readable for debugging.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+#ifdef JSON_WIRE_FORMAT
+#include <json.hpp>
+#endif
+
+namespace codec {
+
+/**
+ * @brief Writes a 32 bit integer in big-endian order.
+ *
+ * @param[in] value integer to write
+ * @param[out] buffer buffer to which the integer is appended
+ */
+void
+writeUint32(const uint32_t& value, std::string& buffer);
+
+/**
+ * @brief Reads a 32 bit integer written in big-endian order.
+ *
+ * @param[in] buffer buffer from which to read
+ * @param[in] offset offset of the integer in the buffer
+ *
+ * @return integer read
+ */
+uint32_t
+readUint32(const std::string_view& buffer, const std::size_t& offset);
+
+/**
+ * @brief Writes a 64 bit integer in big-endian order.
+ *
+ * @param[in] value integer to write
+ * @param[out] buffer buffer to which the integer is appended
+ */
+void
+writeUint64(const uint64_t& value, std::string& buffer);
+
+/**
+ * @brief Reads a 64 bit integer written in big-endian order.
+ *
+ * @param[in] buffer buffer from which to read
+ * @param[in] offset offset of the integer in the buffer
+ *
+ * @return integer read
+ */
+uint64_t
+readUint64(const std::string_view& buffer, const std::size_t& offset);
+
+/**
+ * @brief Computes the CRC-32 checksum of the given bytes.
+ *
+ * The checksum of bytes split over several buffers is computed by passing the
+ * checksum of the previous buffers.
+ *
+ * @param[in] data bytes to checksum
+ * @param[in] size number of bytes
+ * @param[in] crc checksum of the preceding bytes
+ *
+ * @return checksum
+ */
+uint32_t
+crc32(const char* data, const std::size_t& size, const uint32_t& crc = 0);
+
+} // namespace codec
+
+class PayloadWriter {
+public:
+  /**
+   * @brief Default PayloadWriter constructor.
+   *
+   */
+  PayloadWriter() = default;
+
+  /**
+   * @brief Writes an integer.
+   *
+   * @param[in] value integer to write
+   */
+  void
+  write(const int& value);
+
+  /**
+   * @brief Writes a 64 bit integer.
+   *
+   * @param[in] value integer to write
+   */
+  void
+  write(const int64_t& value);
+
+  /**
+   * @brief Writes a string.
+   *
+   * @param[in] value string to write
+   */
+  void
+  write(const std::string& value);
+
+  /**
+   * @brief Writes a list of strings.
+   *
+   * @param[in] values strings to write
+   */
+  void
+  write(const std::vector<std::string>& values);
+
+  /**
+   * @brief Writes a list of strings given as views.
+   *
+   * The strings are read back as a list of strings.
+   *
+   * @param[in] values strings to write
+   */
+  void
+  write(const std::vector<std::string_view>& values);
+
+  /**
+   * @brief Gets the encoded payload.
+   *
+   * @param[out] data encoded payload
+   */
+  void
+  getData(std::string& data) const;
+
+  /**
+   * @brief Moves the encoded payload out of the writer, which is left empty.
+   *
+   * @param[out] data encoded payload
+   */
+  void
+  moveData(std::string& data);
+
+private:
+#ifdef JSON_WIRE_FORMAT
+  nlohmann::json m_json = nlohmann::json::array();
+#else
+  std::string m_data;
+#endif
+};
+
+class PayloadReader {
+public:
+  /**
+   * @brief PayloadReader constructor.
+   *
+   * The given data must outlive the reader.
+   *
+   * @param[in] data encoded payload
+   */
+  PayloadReader(const std::string& data);
+
+  /**
+   * @brief Reads the next value as an integer.
+   *
+   * @param[out] value integer read
+   */
+  void
+  read(int& value);
+
+  /**
+   * @brief Reads the next value as a 64 bit integer.
+   *
+   * @param[out] value integer read
+   */
+  void
+  read(int64_t& value);
+
+  /**
+   * @brief Reads the next value as a string.
+   *
+   * @param[out] value string read
+   */
+  void
+  read(std::string& value);
+
+  /**
+   * @brief Reads the next value as a list of strings.
+   *
+   * @param[out] values strings read
+   */
+  void
+  read(std::vector<std::string>& values);
+
+  /**
+   * @brief Reads the next value as a list of views on the payload.
+   *
+   * The views are only valid as long as the reader and its data.
+   *
+   * @param[out] values views on the strings read
+   */
+  void
+  read(std::vector<std::string_view>& values);
+
+  /**
+   * @brief Returns whether every read value was found in the payload.
+   *
+   * @return whether the payload was valid so far
+   */
+  bool
+  getIsValid() const;
+
+private:
+  bool
+  hasBytes(const std::size_t& size);
+
+#ifdef JSON_WIRE_FORMAT
+  nlohmann::json m_json;
+#else
+  const std::string& m_data;
+#endif
+  std::size_t m_offset = 0;
+  bool m_isValid = true;
+};
@@ -11,23 +11,55 @@
  * single tag. More information on this can be found in the MessageReceiver base
  * class.
  *
+ * By default every receiver receives its messages from the messenger on its
+ * own thread. When the dispatcher is used a single thread receives the
+ * messages of all tags and pushes them to the inbox of their receiver, it also
+ * completes the pending sends of the messenger.
+ *
  */
 #pragma once
 
 #include <array>
 #include <thread>
 #include <memory>
+#include <atomic>
 
 #include "message-info.hh"
 #include "message-receiver.hh"
 
 class ReceiverManager {
 public:
-  /** 
-   * @brief Defaulted constructor
-   * 
+  /**
+   * @brief ReceiverManager constructor
+   *
+   * @param[in] useDispatcher whether messages are received by the dispatcher
+   */
+  ReceiverManager(const bool& useDispatcher = false);
+
+  /**
+   * @brief Starts the dispatcher thread if the dispatcher is used.
+   *
+   * All receivers must be started beforehand.
+   *
+   * @param[in] messenger node's messenger
+   */
+  void
+  startDispatcher(Messenger& messenger);
+
+  /**
+   * @brief Stops the dispatcher thread if it was started.
+   *
+   */
+  void
+  stopDispatcher();
+
+  /**
+   * @brief Gets whether messages are received by the dispatcher.
+   *
+   * @return whether the dispatcher is used
    */
-  ReceiverManager() = default;
+  bool
+  getUsesDispatcher() const;
 
   /** 
    * @brief Logs and starts the receiver's receive loop.
@@ -69,6 +101,10 @@ private:
       m_receivers;
   std::array<std::thread, static_cast<int>(MessageTag::SIZE)> m_threads;
   std::array<bool, static_cast<int>(MessageTag::SIZE)> m_isActive = {false};
+
+  bool m_useDispatcher;
+  std::thread m_dispatcherThread;
+  std::atomic<bool> m_dispatcherIsUp = false;
 };
 
 #include "receiver-manager.hxx"
@@ -0,0 +1,108 @@
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+#include "log-file-manager.hh"
+
+#define BENCH_NODE_ID 99
+#define BENCH_LOG_DIR_PATH "etc/server/log/99"
+#define DEFAULT_THREAD_COUNT 4
+#define DEFAULT_COMMIT_COUNT 500
+#define ENTRY_SIZE 64
+
+// every thread appends an entry and commits it, as the consensus threads do
+// for every applied batch
+void
+commitEntries(LogFileManager& logFileManager,
+              const int& commitCount,
+              std::vector<double>& latencies) {
+  std::vector<std::string> entries(1, std::string(ENTRY_SIZE, 'x'));
+
+  for (int i = 0; i < commitCount; i++) {
+    auto start = std::chrono::steady_clock::now();
+
+    logFileManager.append(entries);
+    logFileManager.commit();
+
+    latencies[i] = std::chrono::duration<double, std::micro>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  }
+}
+
+int
+main(int argc, char* argv[]) {
+  if (argc < 2 || durabilityParseMap.count(argv[1]) == 0) {
+    std::cerr << "usage: " << argv[0]
+              << " <none/group/per-entry> [thread count] [commits per thread]"
+              << std::endl;
+    return 1;
+  }
+
+  Durability durability = durabilityParseMap.at(argv[1]);
+  int threadCount =
+      std::max(argc > 2 ? std::atoi(argv[2]) : DEFAULT_THREAD_COUNT, 1);
+  int commitCount =
+      std::max(argc > 3 ? std::atoi(argv[3]) : DEFAULT_COMMIT_COUNT, 1);
+
+  // every run starts from an empty log
+  std::filesystem::remove_all(BENCH_LOG_DIR_PATH);
+
+  // the log prints a line per append, the output is muted while measuring
+  std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+  std::vector<std::vector<double>> latencies(
+      threadCount, std::vector<double>(commitCount));
+  double elapsed;
+
+  {
+    LogFileManager logFileManager(BENCH_NODE_ID, durability);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++) {
+      threads.emplace_back(commitEntries,
+                           std::ref(logFileManager),
+                           commitCount,
+                           std::ref(latencies[i]));
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  }
+
+  std::cout.rdbuf(coutBuffer);
+  std::cout.clear();
+
+  std::filesystem::remove_all(BENCH_LOG_DIR_PATH);
+
+  std::vector<double> allLatencies;
+  for (const std::vector<double>& threadLatencies : latencies) {
+    allLatencies.insert(
+        allLatencies.end(), threadLatencies.begin(), threadLatencies.end());
+  }
+
+  std::sort(allLatencies.begin(), allLatencies.end());
+
+  std::printf("durability: %s\n", argv[1]);
+  std::printf("threads: %d\n", threadCount);
+  std::printf("commits/s: %.0f\n", allLatencies.size() / elapsed);
+  std::printf("p50 latency us: %.1f\n",
+              allLatencies[allLatencies.size() / 2]);
+  std::printf("p99 latency us: %.1f\n",
+              allLatencies[allLatencies.size() * 99 / 100]);
+
+  return 0;
+}
@@ -1,64 +1,776 @@
-#include <fstream>
-#include <streambuf>
 #include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <chrono>
+#include <charconv>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "log-file-manager.hh"
 #include "message-info.hh"
+#include "payload.hh"
 
-#define LOG_FILE_PATH "etc/server/log/%02d.txt"
+#define LOG_DIR_PATH "etc/server/log/%02d"
+#define SEGMENT_NAME_FORMAT "/%020d"
+#define SEGMENT_EXTENSION ".log"
+#define INDEX_EXTENSION ".idx"
+#define SET_ASIDE_EXTENSION ".orphan"
+#define LOG_FILE_MODE 0644
+#define LOG_BUFFER_SIZE 65536
+#define LOG_SEGMENT_SIZE (64 * 1024 * 1024)
+#define INDEX_ENTRY_SIZE 8
+#define PROBE_NAME "/probe.tmp"
+#define PROBE_RECORD_SIZE 512
+#define PROBE_COUNT 5
 
-LogFileManager::LogFileManager(const int& nodeId) : m_nodeId(nodeId) {
-  char logFile[24];
-  std::sprintf(logFile, LOG_FILE_PATH, nodeId);
+void
+getSegmentPath(const std::string& dirPath,
+               const int& firstIndex,
+               const std::string& extension,
+               std::string& path) {
+  char name[24];
+  std::sprintf(name, SEGMENT_NAME_FORMAT, firstIndex);
 
-  m_logFilePath = std::string(logFile);
+  path = dirPath + name + extension;
 }
 
 void
-writeWithMode(const int& nodeId,
-              const std::string& filePath,
-              const std::string& str,
-              const std::ios_base::openmode& mode,
-              const bool& newline) {
-  std::ofstream ofs(filePath, mode);
+openLogFile(const std::string& filePath, const int& flags, int& fd) {
+  fd = open(filePath.c_str(), O_WRONLY | O_CREAT | flags, LOG_FILE_MODE);
+
+  if (fd == -1) {
+    std::cerr << "log-file-manager.cc: could not open " << filePath
+              << std::endl;
+  }
+}
 
-  ofs << str;
+void
+writeAll(const int& fd, const std::string_view& str) {
+  std::size_t offset = 0;
+  while (offset < str.size()) {
+    ssize_t written = write(fd, str.data() + offset, str.size() - offset);
 
-  if (newline == true) {
-    ofs << std::endl;
+    if (written == -1) {
+      // retry writes interrupted by a signal
+      if (errno != EINTR) {
+        std::cerr << "log-file-manager.cc: write failed" << std::endl;
+        break;
+      }
+    } else {
+      offset += written;
+    }
   }
+}
 
-  ofs.close();
+bool
+readAll(const int& fd,
+        const uint64_t& offset,
+        const uint64_t& size,
+        std::string& data) {
+  data.resize(size);
 
-  std::string printStr("log write: ");
-  printStr.append(str);
-  print::printString(nodeId, printStr);
+  uint64_t readSize = 0;
+  while (readSize < size) {
+    ssize_t count =
+        pread(fd, &data[readSize], size - readSize, offset + readSize);
+
+    if (count == 0 || (count == -1 && errno != EINTR)) {
+      break;
+    } else if (count > 0) {
+      readSize += count;
+    }
+  }
+
+  data.resize(readSize);
+
+  return readSize == size;
+}
+
+void
+getReadFd(const std::string& dirPath, LogFileManager::Segment& segment) {
+  if (segment.readFd == -1) {
+    std::string path;
+    getSegmentPath(dirPath, segment.firstIndex, SEGMENT_EXTENSION, path);
+
+    segment.readFd = open(path.c_str(), O_RDONLY);
+  }
+}
+
+uint64_t
+getFileSize(const std::string& path) {
+  struct stat fileStat;
+
+  return stat(path.c_str(), &fileStat) == 0 ? fileStat.st_size : 0;
+}
+
+// parses the records following the last indexed entry of the segment, stops
+// at the end of the file or at the first torn record
+void
+scanSegment(const std::string& dirPath, LogFileManager::Segment& segment) {
+  std::string path;
+  getSegmentPath(dirPath, segment.firstIndex, SEGMENT_EXTENSION, path);
+  uint64_t fileSize = getFileSize(path);
+
+  // the offsets written after the last synced record are dropped
+  while (segment.offsets.empty() == false &&
+         segment.offsets.back() >= fileSize) {
+    segment.offsets.pop_back();
+  }
+
+  uint64_t offset = 0;
+  segment.entryCount = 0;
+
+  if (segment.offsets.empty() == false) {
+    offset = segment.offsets.back();
+    segment.entryCount = (segment.offsets.size() - 1) * LOG_INDEX_INTERVAL;
+    segment.offsets.pop_back();
+  }
+
+  getReadFd(dirPath, segment);
+
+  std::string data;
+  readAll(segment.readFd, offset, fileSize - offset, data);
+
+  std::size_t position = 0;
+  bool isValid = true;
+  while (isValid == true && position + RECORD_HEADER_SIZE <= data.size()) {
+    uint32_t size = codec::readUint32(data, position);
+    uint32_t checksum = codec::readUint32(data, position + 4);
+
+    isValid = position + RECORD_HEADER_SIZE + size <= data.size() &&
+              codec::crc32(data.data() + position + RECORD_HEADER_SIZE,
+                           size) == checksum;
+
+    if (isValid == true) {
+      if (segment.entryCount % LOG_INDEX_INTERVAL == 0) {
+        segment.offsets.push_back(offset + position);
+      }
+
+      segment.entryCount += 1;
+      position += RECORD_HEADER_SIZE + size;
+    }
+  }
+
+  segment.size = offset + position;
+}
+
+void
+loadIndex(const std::string& dirPath, LogFileManager::Segment& segment) {
+  std::string path;
+  getSegmentPath(dirPath, segment.firstIndex, INDEX_EXTENSION, path);
+
+  int fd = open(path.c_str(), O_RDONLY);
+
+  std::string data;
+  if (fd != -1) {
+    readAll(fd, 0, getFileSize(path), data);
+    close(fd);
+  }
+
+  segment.offsets.clear();
+  for (std::size_t i = 0; i + INDEX_ENTRY_SIZE <= data.size();
+       i += INDEX_ENTRY_SIZE) {
+    segment.offsets.push_back(codec::readUint64(data, i));
+  }
+}
+
+void
+storeIndex(const std::string& dirPath, const LogFileManager::Segment& segment) {
+  std::string path;
+  getSegmentPath(dirPath, segment.firstIndex, INDEX_EXTENSION, path);
+
+  std::string data;
+  for (const uint64_t& offset : segment.offsets) {
+    codec::writeUint64(offset, data);
+  }
+
+  int fd;
+  openLogFile(path, O_TRUNC, fd);
+  writeAll(fd, data);
+  close(fd);
+}
+
+void
+removeSegment(const std::string& dirPath, LogFileManager::Segment& segment) {
+  if (segment.readFd != -1) {
+    close(segment.readFd);
+  }
+
+  std::string path;
+  getSegmentPath(dirPath, segment.firstIndex, SEGMENT_EXTENSION, path);
+  unlink(path.c_str());
+
+  getSegmentPath(dirPath, segment.firstIndex, INDEX_EXTENSION, path);
+  unlink(path.c_str());
+}
+
+// renames the files of a segment which cannot be part of the log, so that
+// they are kept for inspection but no longer loaded
+void
+setSegmentAside(const std::string& dirPath, LogFileManager::Segment& segment) {
+  if (segment.readFd != -1) {
+    close(segment.readFd);
+  }
+
+  for (const char* extension : {SEGMENT_EXTENSION, INDEX_EXTENSION}) {
+    std::string path;
+    getSegmentPath(dirPath, segment.firstIndex, extension, path);
+
+    std::string asidePath = path + SET_ASIDE_EXTENSION;
+    rename(path.c_str(), asidePath.c_str());
+  }
+}
+
+// checks the records of the last segment, the records torn by a crash are
+// truncated
+void
+recoverLastSegment(const std::string& dirPath,
+                   LogFileManager::Segment& segment) {
+  std::string path;
+  getSegmentPath(dirPath, segment.firstIndex, SEGMENT_EXTENSION, path);
+  uint64_t fileSize = getFileSize(path);
+
+  scanSegment(dirPath, segment);
+
+  if (segment.size < fileSize) {
+    ::truncate(path.c_str(), segment.size);
+  }
+
+  storeIndex(dirPath, segment);
+}
+
+// gets the offset of the entry at the given position in the segment, the
+// position may be the one following the last entry
+bool
+locateEntry(const std::string& dirPath,
+            LogFileManager::Segment& segment,
+            const int& position,
+            uint64_t& offset) {
+  bool isValid = true;
+
+  if (position == segment.entryCount) {
+    offset = segment.size;
+  } else {
+    offset = segment.offsets[position / LOG_INDEX_INTERVAL];
+
+    getReadFd(dirPath, segment);
+
+    // hop over the record headers following the indexed entry
+    std::string header;
+    for (int i = 0; i < position % LOG_INDEX_INTERVAL && isValid == true;
+         i++) {
+      isValid = readAll(segment.readFd, offset, RECORD_HEADER_SIZE, header);
+
+      if (isValid == true) {
+        offset += RECORD_HEADER_SIZE + codec::readUint32(header, 0);
+      }
+    }
+  }
+
+  return isValid;
+}
+
+LogFileManager::LogFileManager(const int& nodeId, const Durability& durability)
+    : m_nodeId(nodeId), m_durability(durability) {
+  char logDir[24];
+  std::sprintf(logDir, LOG_DIR_PATH, nodeId);
+
+  m_logDirPath = std::string(logDir);
+
+  std::filesystem::create_directories(m_logDirPath);
+
+  for (const auto& file : std::filesystem::directory_iterator(m_logDirPath)) {
+    std::string stem = file.path().stem().string();
+    const char* stemEnd = stem.data() + stem.size();
+
+    // stray files which are not named after a log index are ignored
+    int firstIndex;
+    auto [end, error] = std::from_chars(stem.data(), stemEnd, firstIndex);
+    bool isSegment = file.path().extension() == SEGMENT_EXTENSION &&
+                     error == std::errc() && end == stemEnd && firstIndex >= 0;
+
+    if (isSegment == true) {
+      m_segments[firstIndex].firstIndex = firstIndex;
+    }
+  }
+
+  if (m_segments.empty() == true) {
+    m_segments[0].firstIndex = 0;
+  }
+
+  for (auto ite = m_segments.begin(); ite != m_segments.end(); ite++) {
+    Segment& segment = ite->second;
+    auto next = std::next(ite);
+
+    loadIndex(m_logDirPath, segment);
+
+    if (next != m_segments.end()) {
+      // the index of a full segment is trusted if it covers all its entries,
+      // only the records following the last indexed one are read to count
+      // them
+      int entryCount = next->first - segment.firstIndex;
+      std::size_t indexSize =
+          (entryCount + LOG_INDEX_INTERVAL - 1) / LOG_INDEX_INTERVAL;
+      bool isIndexed = segment.offsets.size() == indexSize;
+
+      if (isIndexed == false) {
+        segment.offsets.clear();
+      }
+
+      scanSegment(m_logDirPath, segment);
+
+      if (isIndexed == false) {
+        storeIndex(m_logDirPath, segment);
+      }
+    } else {
+      recoverLastSegment(m_logDirPath, segment);
+    }
+  }
+
+  // the log must hold every entry from the first one on. The segments
+  // following a missing range cannot be indexed, they are set aside and the
+  // log ends before the gap, the missing entries are sent again by the leader
+  // when this node recovers
+  int nextIndex = 0;
+  auto gapIte = m_segments.begin();
+  while (gapIte != m_segments.end() && gapIte->first == nextIndex) {
+    nextIndex = gapIte->first + gapIte->second.entryCount;
+    gapIte++;
+  }
+
+  if (gapIte != m_segments.end()) {
+    std::cerr << "log-file-manager.cc: entries " << nextIndex << " to "
+              << gapIte->first - 1 << " are missing from " << m_logDirPath
+              << ", the segments from " << gapIte->first << " on are set aside"
+              << std::endl;
+
+    while (gapIte != m_segments.end()) {
+      setSegmentAside(m_logDirPath, gapIte->second);
+      gapIte = m_segments.erase(gapIte);
+    }
+
+    if (m_segments.empty() == true) {
+      m_segments[0].firstIndex = 0;
+    } else {
+      recoverLastSegment(m_logDirPath, m_segments.rbegin()->second);
+    }
+  }
+
+  Segment& lastSegment = m_segments.rbegin()->second;
+  m_entryCount = lastSegment.firstIndex + lastSegment.entryCount;
+
+  this->openSegment(lastSegment, O_APPEND);
+
+  m_buffer.reserve(LOG_BUFFER_SIZE);
+}
+
+LogFileManager::~LogFileManager() {
+  if (m_durability == Durability::NONE) {
+    this->flush();
+  } else {
+    this->sync();
+  }
+
+  close(m_fd);
+  close(m_indexFd);
+
+  for (auto& [firstIndex, segment] : m_segments) {
+    if (segment.readFd != -1) {
+      close(segment.readFd);
+    }
+  }
+}
+
+void
+LogFileManager::openSegment(Segment& segment, const int& flags) {
+  std::string path;
+  getSegmentPath(m_logDirPath, segment.firstIndex, SEGMENT_EXTENSION, path);
+  openLogFile(path, flags, m_fd);
+
+  getSegmentPath(m_logDirPath, segment.firstIndex, INDEX_EXTENSION, path);
+  openLogFile(path, flags, m_indexFd);
+}
+
+void
+LogFileManager::flushLocked() {
+  if (m_buffer.empty() == false) {
+    writeAll(m_fd, m_buffer);
+
+    m_buffer.clear();
+  }
+
+  // the index is written after the records it points to
+  if (m_indexBuffer.empty() == false) {
+    writeAll(m_indexFd, m_indexBuffer);
+
+    m_indexBuffer.clear();
+  }
+}
+
+void
+LogFileManager::rollLocked(std::unique_lock<std::mutex>& lock) {
+  // the descriptors cannot be closed under a running group sync
+  m_syncConditional.wait(lock, [&] { return m_isSyncing == false; });
+
+  this->flushLocked();
+
+  if (m_durability != Durability::NONE) {
+    fdatasync(m_fd);
+    fdatasync(m_indexFd);
+  }
+
+  close(m_fd);
+  close(m_indexFd);
+
+  Segment& segment = m_segments[m_entryCount];
+  segment.firstIndex = m_entryCount;
+
+  this->openSegment(segment, O_TRUNC);
+}
+
+void
+LogFileManager::appendLocked(const std::string_view& entry) {
+  Segment& segment = m_segments.rbegin()->second;
+
+  if (segment.entryCount % LOG_INDEX_INTERVAL == 0) {
+    segment.offsets.push_back(segment.size);
+    codec::writeUint64(segment.size, m_indexBuffer);
+  }
+
+  codec::writeUint32(entry.size(), m_buffer);
+  codec::writeUint32(codec::crc32(entry.data(), entry.size()), m_buffer);
+  m_buffer.append(entry);
+
+  segment.size += RECORD_HEADER_SIZE + entry.size();
+  segment.entryCount += 1;
+  m_entryCount += 1;
 }
 
 void
 LogFileManager::append(const std::string& entry) {
+  this->append(std::vector<std::string>({entry}));
+}
+
+void
+LogFileManager::append(const std::vector<std::string>& entries) {
+  std::vector<std::string_view> views(entries.begin(), entries.end());
+
+  this->append(views);
+}
+
+void
+LogFileManager::append(const std::vector<std::string_view>& entries) {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (const std::string_view& entry : entries) {
+      this->appendLocked(entry);
+
+      if (m_segments.rbegin()->second.size >= LOG_SEGMENT_SIZE) {
+        this->rollLocked(lock);
+      }
+    }
+
+    m_appendCount += 1;
+
+    if (m_buffer.size() >= LOG_BUFFER_SIZE) {
+      this->flushLocked();
+    }
+  }
+
+  std::string printStr("log write: ");
+  printStr.append(std::to_string(entries.size()));
+  printStr.append(" entries");
+  print::printString(m_nodeId, printStr);
+}
+
+void
+LogFileManager::truncate(const int& entryCount) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  // the descriptors cannot be closed under a running group sync
+  m_syncConditional.wait(lock, [&] { return m_isSyncing == false; });
+
+  if (entryCount < m_entryCount) {
+    this->flushLocked();
+
+    close(m_fd);
+    close(m_indexFd);
+
+    while (m_segments.size() > 1 &&
+           m_segments.rbegin()->first >= entryCount) {
+      removeSegment(m_logDirPath, m_segments.rbegin()->second);
+      m_segments.erase(std::prev(m_segments.end()));
+    }
+
+    Segment& segment = m_segments.rbegin()->second;
+    int position = std::max(entryCount - segment.firstIndex, 0);
+
+    uint64_t offset;
+    locateEntry(m_logDirPath, segment, position, offset);
+
+    std::string path;
+    getSegmentPath(m_logDirPath, segment.firstIndex, SEGMENT_EXTENSION, path);
+    ::truncate(path.c_str(), offset);
+
+    segment.size = offset;
+    segment.entryCount = position;
+    segment.offsets.resize((position + LOG_INDEX_INTERVAL - 1) /
+                           LOG_INDEX_INTERVAL);
+    storeIndex(m_logDirPath, segment);
+
+    this->openSegment(segment, O_APPEND);
+
+    if (m_durability != Durability::NONE) {
+      fdatasync(m_fd);
+    }
+
+    m_entryCount = segment.firstIndex + position;
+  }
+}
+
+bool
+LogFileManager::openReader(LogReader& reader) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  // the buffered records have to be visible in the mapping
+  this->flushLocked();
+
+  bool isMapped = true;
+  for (const auto& [firstIndex, segment] : m_segments) {
+    std::string path;
+    getSegmentPath(m_logDirPath, firstIndex, SEGMENT_EXTENSION, path);
+
+    isMapped = reader.mapSegment(path,
+                                 firstIndex,
+                                 segment.entryCount,
+                                 segment.size,
+                                 segment.offsets) &&
+               isMapped;
+  }
+
+  return isMapped;
+}
+
+bool
+LogFileManager::readEntriesLocked(const int& firstIndex,
+                                  const int& count,
+                                  std::vector<std::string>& entries) {
+  entries.clear();
+
+  if (firstIndex < 0) {
+    return false;
+  }
+
+  // the buffered records have to be visible to the reader
+  this->flushLocked();
+
+  int index = firstIndex;
+  int lastIndex = std::min(firstIndex + count, m_entryCount);
+
+  bool isValid = true;
+  while (index < lastIndex && isValid == true) {
+    Segment& segment = std::prev(m_segments.upper_bound(index))->second;
+    int position = index - segment.firstIndex;
+    int endPosition =
+        std::min(lastIndex - segment.firstIndex, segment.entryCount);
+
+    // the records of the segment are read at once
+    uint64_t offset;
+    uint64_t endOffset;
+    isValid = locateEntry(m_logDirPath, segment, position, offset) &&
+              locateEntry(m_logDirPath, segment, endPosition, endOffset);
+
+    std::string data;
+    if (isValid == true) {
+      getReadFd(m_logDirPath, segment);
+      isValid = readAll(segment.readFd, offset, endOffset - offset, data);
+    }
+
+    std::size_t dataPosition = 0;
+    for (int i = position; i < endPosition && isValid == true; i++) {
+      uint32_t size = codec::readUint32(data, dataPosition);
+      uint32_t checksum = codec::readUint32(data, dataPosition + 4);
+      const char* entry = data.data() + dataPosition + RECORD_HEADER_SIZE;
+
+      isValid = codec::crc32(entry, size) == checksum;
+
+      if (isValid == true) {
+        entries.emplace_back(entry, size);
+        dataPosition += RECORD_HEADER_SIZE + size;
+      }
+    }
+
+    index = segment.firstIndex + endPosition;
+  }
+
+  return isValid;
+}
+
+bool
+LogFileManager::readEntries(const int& firstIndex,
+                            const int& count,
+                            std::vector<std::string>& entries) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  return this->readEntriesLocked(firstIndex, count, entries);
+}
+
+bool
+LogFileManager::getChecksum(const int& index, uint32_t& checksum) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  bool isValid = index >= 0 && index < m_entryCount;
+
+  if (isValid == true) {
+    // the buffered records have to be visible to the reader
+    this->flushLocked();
+
+    Segment& segment = std::prev(m_segments.upper_bound(index))->second;
+
+    int position = index - segment.firstIndex;
+
+    uint64_t offset;
+    std::string header;
+    isValid = locateEntry(m_logDirPath, segment, position, offset) &&
+              readAll(segment.readFd, offset, RECORD_HEADER_SIZE, header);
+
+    if (isValid == true) {
+      checksum = codec::readUint32(header, 4);
+    }
+  }
+
+  return isValid;
+}
+
+bool
+LogFileManager::readEntry(const int& index, std::string& entry) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  std::vector<std::string> entries;
+  bool isValid = this->readEntriesLocked(index, 1, entries);
+
+  isValid = isValid == true && entries.size() == 1;
+
+  if (isValid == true) {
+    entry = std::move(entries[0]);
+  }
+
+  return isValid;
+}
+
+int64_t
+LogFileManager::measureAppendLatency() {
+  std::string probePath = m_logDirPath + PROBE_NAME;
+
+  int fd;
+  openLogFile(probePath, O_TRUNC, fd);
+
+  std::vector<int64_t> latencies;
+  std::string record(PROBE_RECORD_SIZE, '\0');
+
+  for (int i = 0; i < PROBE_COUNT && fd != -1; i++) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    writeAll(fd, record);
+
+    if (m_durability != Durability::NONE) {
+      fdatasync(fd);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    latencies.push_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count());
+  }
+
+  if (fd != -1) {
+    close(fd);
+    unlink(probePath.c_str());
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+
+  return latencies.empty() == false ? latencies[latencies.size() / 2] : 0;
+}
+
+void
+LogFileManager::flush() {
   std::unique_lock<std::mutex> lock(m_mutex);
 
-  writeWithMode(m_nodeId, m_logFilePath, entry, std::ios_base::app, true);
+  this->flushLocked();
 }
 
 void
-LogFileManager::replace(const std::string& contents) {
+LogFileManager::sync() {
   std::unique_lock<std::mutex> lock(m_mutex);
-  writeWithMode(m_nodeId, m_logFilePath, contents, std::ios_base::out, false);
+
+  this->flushLocked();
+
+  fdatasync(m_fd);
+  m_syncedCount = m_appendCount;
 }
 
 void
-LogFileManager::read(std::string& contents) {
-  std::ifstream ifs(m_logFilePath);
+LogFileManager::groupSync(const bool& isShared) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  uint64_t appendCount = m_appendCount;
 
-  if (ifs.good()) {
-    ifs.seekg(0, std::ios::end);
+  // an unshared sync is run by the calling thread even if the sync of another
+  // thread covered its entries
+  bool isSynced = isShared == true && m_syncedCount >= appendCount;
 
-    contents.reserve(ifs.tellg());
-    ifs.seekg(0, std::ios::beg);
+  while (isSynced == false) {
+    if (m_isSyncing == true) {
+      // the running sync might not cover our entries, wait for it to end and
+      // check again. The appends made meanwhile are covered by the next one
+      m_syncConditional.wait(lock);
 
-    contents.assign((std::istreambuf_iterator<char>(ifs)),
-                    std::istreambuf_iterator<char>());
+      isSynced = isShared == true && m_syncedCount >= appendCount;
+    } else {
+      m_isSyncing = true;
+
+      uint64_t syncCount = m_appendCount;
+      this->flushLocked();
+
+      // appends can go on while the file is synced
+      int fd = m_fd;
+      lock.unlock();
+      fdatasync(fd);
+      lock.lock();
+
+      m_syncedCount = std::max(m_syncedCount, syncCount);
+      m_isSyncing = false;
+      isSynced = true;
+
+      m_syncConditional.notify_all();
+    }
+  }
+}
+
+void
+LogFileManager::commit() {
+  switch (m_durability) {
+  case Durability::NONE: {
+    this->flush();
+    break;
   }
+  case Durability::GROUP: {
+    this->groupSync(true);
+    break;
+  }
+  case Durability::PER_ENTRY: {
+    this->groupSync(false);
+    break;
+  }
+  }
+}
+
+int
+LogFileManager::getEntryCount() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  return m_entryCount;
 }
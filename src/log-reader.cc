@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "log-reader.hh"
+#include "log-file-manager.hh"
+#include "payload.hh"
+
+LogReader::~LogReader() {
+  for (auto& [firstIndex, mapping] : m_mappings) {
+    if (mapping.size > 0) {
+      munmap(const_cast<char*>(mapping.data), mapping.size);
+    }
+  }
+}
+
+bool
+mapFile(const std::string& path, const uint64_t& size, const char*& data) {
+  bool isMapped = false;
+
+  int fd = open(path.c_str(), O_RDONLY);
+
+  if (fd != -1) {
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    isMapped = mapping != MAP_FAILED;
+
+    if (isMapped == true) {
+      // the entries are mostly read from start to end
+      madvise(mapping, size, MADV_SEQUENTIAL);
+
+      data = static_cast<const char*>(mapping);
+    }
+  }
+
+  return isMapped;
+}
+
+bool
+LogReader::mapSegment(const std::string& path,
+                      const int& firstIndex,
+                      const int& entryCount,
+                      const uint64_t& size,
+                      const std::vector<uint64_t>& offsets) {
+  Mapping mapping = {entryCount, nullptr, size, offsets};
+
+  // empty segments cannot be mapped and have nothing to read anyway
+  bool isMapped = size == 0 || mapFile(path, size, mapping.data) == true;
+
+  if (isMapped == true) {
+    m_mappings[firstIndex] = mapping;
+  }
+
+  return isMapped;
+}
+
+bool
+LogReader::getEntries(const int& firstIndex,
+                      const int& count,
+                      std::vector<std::string_view>& entries) const {
+  entries.clear();
+
+  if (m_mappings.empty() == true) {
+    return true;
+  }
+
+  int index = std::max(firstIndex, m_mappings.begin()->first);
+  int lastIndex = std::min(firstIndex + count, this->getEntryCount());
+
+  bool isValid = true;
+  while (index < lastIndex && isValid == true) {
+    auto ite = std::prev(m_mappings.upper_bound(index));
+    const Mapping& mapping = ite->second;
+    int position = index - ite->first;
+    int endPosition = std::min(lastIndex - ite->first, mapping.entryCount);
+
+    uint64_t offset = mapping.offsets[position / LOG_INDEX_INTERVAL];
+    std::string_view data(mapping.data, mapping.size);
+
+    // hop over the records preceding the first one within the index interval
+    int recordPosition = position - position % LOG_INDEX_INTERVAL;
+    for (; recordPosition < endPosition && isValid == true; recordPosition++) {
+      isValid = offset + RECORD_HEADER_SIZE <= mapping.size;
+
+      uint32_t size = 0;
+      if (isValid == true) {
+        size = codec::readUint32(data, offset);
+        isValid = offset + RECORD_HEADER_SIZE + size <= mapping.size;
+      }
+
+      if (isValid == true && recordPosition >= position) {
+        const char* entry = mapping.data + offset + RECORD_HEADER_SIZE;
+        isValid = codec::crc32(entry, size) ==
+                  codec::readUint32(data, offset + 4);
+
+        entries.emplace_back(entry, size);
+      }
+
+      offset += RECORD_HEADER_SIZE + size;
+    }
+
+    index = ite->first + endPosition;
+  }
+
+  return isValid;
+}
+
+bool
+LogReader::getChecksum(const int& index, uint32_t& checksum) const {
+  bool isValid = m_mappings.empty() == false &&
+                 index >= m_mappings.begin()->first &&
+                 index < this->getEntryCount();
+
+  if (isValid == true) {
+    auto ite = std::prev(m_mappings.upper_bound(index));
+    const Mapping& mapping = ite->second;
+    int position = index - ite->first;
+
+    uint64_t offset = mapping.offsets[position / LOG_INDEX_INTERVAL];
+    std::string_view data(mapping.data, mapping.size);
+
+    // hop over the records preceding the entry within the index interval
+    for (int i = 0; i < position % LOG_INDEX_INTERVAL && isValid == true;
+         i++) {
+      offset += RECORD_HEADER_SIZE + codec::readUint32(data, offset);
+      isValid = offset + RECORD_HEADER_SIZE <= mapping.size;
+    }
+
+    if (isValid == true) {
+      checksum = codec::readUint32(data, offset + 4);
+    }
+  }
+
+  return isValid;
+}
+
+int
+LogReader::getEntryCount() const {
+  int entryCount = 0;
+
+  if (m_mappings.empty() == false) {
+    auto last = m_mappings.rbegin();
+    entryCount = last->first + last->second.entryCount;
+  }
+
+  return entryCount;
+}
@@ -1,9 +1,12 @@
 #include <iostream>
 #include <thread>
+#include <chrono>
+#include <algorithm>
 
 #include <json.hpp>
 
 #include "client-manager.hh"
+#include "payload.hh"
 #include "consensus-manager.hh"
 #include "election-manager.hh"
 #include "failure-manager.hh"
@@ -12,8 +15,14 @@
 #define LOOP_SLEEP_DURATION 100
 
 ClientManager::ClientManager(Messenger& messenger,
-                             std::shared_ptr<ReceiverManager> receiverManager)
+                             std::shared_ptr<ReceiverManager> receiverManager,
+                             const int& batchWait,
+                             const int& batchMaxSize,
+                             const int& batchWorkerCount)
     : MessageReceiver(messenger, managedTag, receiverManager) {
+  m_batch.waitDuration = std::max(batchWait, 0);
+  m_batch.maxSize = std::max(batchMaxSize, 1);
+  m_batchThreads.resize(std::max(batchWorkerCount, 1));
 }
 
 void
@@ -23,28 +32,131 @@ ClientManager::handleMessage(const int& srcNodeId,
   ClientCode code = receivedMessage.getCode<ClientCode>();
   switch (code) {
   case ClientCode::REPLICATE: {
-    const std::string& data = receivedMessage.getData();
+    PayloadReader reader(receivedMessage.getData());
 
-    nlohmann::json dataJson = nlohmann::json::parse(data);
     std::string value;
-    dataJson.at("value").get_to(value);
-    
-    std::shared_ptr<ConsensusManager> consensusManager =
-        m_receiverManager->getReceiver<ConsensusManager>();
+    reader.read(value);
 
-    // block the thread until the consensus is reached or timeout occurs
-    bool consensusReached;
-    consensusManager->startConsensus(value, consensusReached);
+    // the request is answered by the batcher thread once its batch is decided
+    {
+      std::unique_lock<std::mutex> lock(m_batch.mutex);
 
-    if (consensusReached == true) {
-      Message message;
-      m_messenger.setMessage(ClientCode::SUCCESS, message);
-
-      m_messenger.send(srcNodeId, message, connection);
+      m_batch.requests.push_back(
+          {value, srcNodeId, connection, m_batch.connectionId});
     }
 
+    m_batch.conditional.notify_all();
+
     break;
   }
+  case ClientCode::SHUTDOWN:
+  case ClientCode::PORT:
+  case ClientCode::DISCONNECT:
+  case ClientCode::SUCCESS:
+  case ClientCode::NOT_LEADER: {
+    // handled by the receive loop or only ever sent to the clients
+    break;
+  }
+  }
+}
+
+void
+replicateBatch(Messenger& messenger,
+               std::shared_ptr<ReceiverManager> receiverManager,
+               ClientManager::Batch& batch,
+               std::vector<ClientManager::Request> requests) {
+  std::vector<std::string> values;
+  for (const ClientManager::Request& request : requests) {
+    values.push_back(request.value);
+  }
+
+  std::shared_ptr<ConsensusManager> consensusManager =
+      receiverManager->getReceiver<ConsensusManager>();
+
+  // block the thread until the consensus is reached or timeout occurs
+  bool consensusReached;
+  consensusManager->startConsensus(values, consensusReached);
+
+  std::shared_ptr<ElectionManager> electionManager =
+      receiverManager->getReceiver<ElectionManager>();
+
+  // a node which handed the leadership over dropped the requests without
+  // proposing them, the clients retry with the new leader right away
+  bool isLeader = electionManager->getLeaderNodeId() == messenger.getRank();
+
+  // the client may have disconnected while the batch was proposed, its
+  // connection is then freed and the answers are dropped
+  std::unique_lock<std::mutex> lock(batch.mutex);
+
+  if (consensusReached == true || isLeader == false) {
+    ClientCode code =
+        consensusReached == true ? ClientCode::SUCCESS : ClientCode::NOT_LEADER;
+
+    for (const ClientManager::Request& request : requests) {
+      if (request.connectionId != batch.connectionId) {
+        continue;
+      }
+
+      Message message;
+      messenger.setMessage(code, message);
+
+      messenger.send(request.srcNodeId, message, request.connection);
+    }
+  }
+
+  batch.inFlightCount--;
+}
+
+// proposes the queued requests one batch at a time, the workers propose their
+// batches concurrently
+void
+replicateBatches(Messenger& messenger,
+                 std::shared_ptr<ReceiverManager> receiverManager,
+                 ClientManager::Batch& batch) {
+  bool isUp = true;
+  while (isUp == true) {
+    std::vector<ClientManager::Request> requests;
+
+    {
+      std::unique_lock<std::mutex> lock(batch.mutex);
+
+      // a single worker gathers a batch at a time
+      batch.conditional.wait(lock, [&] {
+        return (batch.requests.empty() == false &&
+                batch.isGathering == false) ||
+               batch.isUp == false;
+      });
+
+      // while other batches are proposed the requests arriving shortly after
+      // the first one join it, a lone request is proposed right away
+      if (batch.inFlightCount > 0 && batch.isUp == true) {
+        batch.isGathering = true;
+
+        auto deadline = std::chrono::high_resolution_clock::now() +
+                        std::chrono::milliseconds(batch.waitDuration);
+        batch.conditional.wait_until(lock, deadline, [&] {
+          return batch.requests.size() >= batch.maxSize ||
+                 batch.isUp == false;
+        });
+
+        batch.isGathering = false;
+      }
+
+      std::size_t size = std::min(batch.requests.size(), batch.maxSize);
+      requests.assign(batch.requests.begin(), batch.requests.begin() + size);
+      batch.requests.erase(batch.requests.begin(),
+                           batch.requests.begin() + size);
+
+      batch.inFlightCount += requests.empty() == true ? 0 : 1;
+      isUp = batch.isUp;
+    }
+
+    // the next worker gathers the requests left over
+    batch.conditional.notify_all();
+
+    if (requests.empty() == false) {
+      replicateBatch(messenger, receiverManager, batch, requests);
+    }
   }
 }
 
@@ -84,7 +196,12 @@ ClientManager::receivePendingMessages() {
 
         this->handleMessage(srcNodeId, receivedMessage, m_clientConnection);
       } else {
-        m_messenger.disconnect(m_clientConnection);
+        {
+          std::unique_lock<std::mutex> lock(m_batch.mutex);
+
+          m_messenger.disconnect(m_clientConnection);
+          m_batch.connectionId++;
+        }
 
         std::shared_ptr<FailureManager> failureManager =
           m_receiverManager->getReceiver<FailureManager>();
@@ -112,10 +229,10 @@ sendPort(const Messenger& messenger, const std::string& port) {
 }
 
 void
-receivePort(const Messenger& messenger, std::string& nextNodePort) {
+receivePort(MessageReceiver& receiver, std::string& nextNodePort) {
   int srcNodeId;
   Message receivedMessage;
-  messenger.receiveWithTagBlock(MessageTag::CLIENT, srcNodeId, receivedMessage);
+  receiver.receiveMessage(srcNodeId, receivedMessage);
 
   const std::string& messageString = receivedMessage.getData();
   nlohmann::json messageJson = nlohmann::json::parse(messageString);
@@ -126,13 +243,14 @@ receivePort(const Messenger& messenger, std::string& nextNodePort) {
 // the system
 void
 exchangePorts(const Messenger& messenger,
+              MessageReceiver& receiver,
               const std::string& port,
               std::string& nextNodePort) {
   if (messenger.getRank() == 0) {
     sendPort(messenger, port);
-    receivePort(messenger, nextNodePort);
+    receivePort(receiver, nextNodePort);
   } else {
-    receivePort(messenger, nextNodePort);
+    receivePort(receiver, nextNodePort);
     sendPort(messenger, port);
   }
 }
@@ -161,15 +279,39 @@ void
 ClientManager::startReceiver() {
   m_messenger.openPort(m_port);
 
-  exchangePorts(m_messenger, m_port, m_nextNodePort);
+  exchangePorts(m_messenger, *this, m_port, m_nextNodePort);
 
   std::shared_ptr<FailureManager> failureManager =
       m_receiverManager->getReceiver<FailureManager>();
 
+  // the recovery lock is held by this thread unless it waits for a client
+  failureManager->disallowRecovery();
+
+  for (std::thread& batchThread : m_batchThreads) {
+    batchThread = std::thread(replicateBatches,
+                              std::ref(m_messenger),
+                              m_receiverManager,
+                              std::ref(m_batch));
+  }
+
   acceptConnection(m_messenger, failureManager, m_port, m_clientConnection);
 
   this->receivePendingMessages();
 
+  {
+    std::unique_lock<std::mutex> lock(m_batch.mutex);
+
+    m_batch.isUp = false;
+  }
+
+  // the batches being proposed use the messenger and the log, the workers
+  // are joined before they are torn down
+  m_batch.conditional.notify_all();
+
+  for (std::thread& batchThread : m_batchThreads) {
+    batchThread.join();
+  }
+
   m_messenger.disconnect(m_clientConnection);
 
   std::shared_ptr<ElectionManager> electionManager =
@@ -2,72 +2,149 @@
 #include <thread>
 #include <optional>
 #include <iostream>
-#include <json.hpp>
 #include <cstdio>
 #include <fstream>
+#include <vector>
+#include <algorithm>
 
 #include "consensus-manager.hh"
+#include "payload.hh"
 
 #define PROMISE_WAIT_DURATION 5
 #define ACCEPT_WAIT_DURATION 5
-#define LOG_WRITE_DURATION 3
+#define CATCH_UP_WAIT_DURATION 500
+#define NOOP_VALUE ""
 
 ConsensusManager::ConsensusManager(
     Messenger& messenger,
     std::shared_ptr<ReceiverManager> receiverManager,
-    LogFileManager& logFileManager)
+    LogFileManager& logFileManager,
+    const int& windowSize)
     : MessageReceiver(messenger, managedTag, receiverManager),
       m_logFileManager(logFileManager) {
+  m_context.windowSize = std::max(windowSize, 1);
+}
+
+bool
+hasMajority(const Messenger& messenger, const int& count) {
+  int clusterSize = messenger.getClusterSize();
+
+  // the count includes the promise or accept of the proposer itself
+  return count >= clusterSize / 2 + 1;
 }
 
 void
-receiveAccepts(const Messenger& messenger,
-               std::mutex& mutex,
-               ConsensusManager::Context& context,
-               bool& majorityAccepted) {
-  // pause the current thread to let the consensus thread receive the accepts
-  std::this_thread::sleep_for(std::chrono::seconds(ACCEPT_WAIT_DURATION));
+applyDecided(LogFileManager& logFileManager,
+             ConsensusManager::Context& context) {
+  int firstSlot = logFileManager.getEntryCount();
+  int nextSlot = firstSlot;
+  std::vector<std::string> entries;
+
+  // gather every decided value following the last entry of the log. Values
+  // of slots already in the log (e.g. after a recovery) are dropped
+  auto ite = context.decided.begin();
+  while (ite != context.decided.end() && ite->first <= nextSlot) {
+    if (ite->first == nextSlot) {
+      entries.push_back(ite->second);
+      nextSlot += 1;
+    }
 
-  int clusterSize = messenger.getClusterSize();
+    ite = context.decided.erase(ite);
+  }
 
-  {
-    std::unique_lock<std::mutex> lock(mutex);
+  // the applied batch is made durable by the next commit of the log
+  if (entries.empty() == false) {
+    logFileManager.append(entries);
+  }
+
+  // the accepted values of the last window of applied slots are kept for
+  // leaders that might not have learned them yet
+  auto acceptedEnd =
+      context.accepted.lower_bound(nextSlot - context.windowSize);
+  context.accepted.erase(context.accepted.begin(), acceptedEnd);
+}
 
-    majorityAccepted = context.acceptCount >= ((clusterSize - 1) / 2);
+void
+learnValues(const int& slot,
+            const std::vector<std::string>& values,
+            LogFileManager& logFileManager,
+            ConsensusManager::Context& context) {
+  for (std::size_t i = 0; i < values.size(); i++) {
+    context.decided[slot + i] = values[i];
   }
 
+  applyDecided(logFileManager, context);
 }
 
 void
-receivePromises(const Messenger& messenger,
-                std::mutex& mutex,
-                ConsensusManager::Context& context,
-                bool& majorityPromised) {
-  // pause the current thread to let the consensus thread receive the promises
-  std::this_thread::sleep_for(std::chrono::seconds(PROMISE_WAIT_DURATION));
+updateDecision(const Messenger& messenger,
+               const int& slot,
+               LogFileManager& logFileManager,
+               std::condition_variable& quorumConditional,
+               ConsensusManager::Context& context) {
+  ConsensusManager::Instance& instance = context.instances[slot];
 
-  int clusterSize = messenger.getClusterSize();
+  if (instance.isDecided == false &&
+      hasMajority(messenger, instance.acceptCount) == true) {
+    instance.isDecided = true;
 
+    learnValues(slot, instance.values, logFileManager, context);
 
-  {
-    std::unique_lock<std::mutex> lock(mutex);
+    // wake the thread that proposed this slot
+    quorumConditional.notify_all();
+  }
+}
 
-    majorityPromised = context.promiseCount >= ((clusterSize - 1) / 2);
+void
+addInstance(const Messenger& messenger,
+            const int& slot,
+            const std::vector<std::string>& values,
+            LogFileManager& logFileManager,
+            std::condition_variable& quorumConditional,
+            ConsensusManager::Context& context) {
+  ConsensusManager::Instance instance;
+  instance.roundId = context.leaderRoundId;
+  instance.values = values;
+
+  // the proposer accepts its own proposal
+  instance.acceptCount = 1;
+
+  context.instances[slot] = instance;
+
+  for (std::size_t i = 0; i < values.size(); i++) {
+    context.accepted[slot + i] = {instance.roundId, values[i]};
   }
 
+  updateDecision(messenger, slot, logFileManager, quorumConditional, context);
 }
 
 void
 broadcastPrepare(const Messenger& messenger,
+                 LogFileManager& logFileManager,
                  std::mutex& mutex,
                  ConsensusManager::Context& context) {
+  // every slot that is not in the log yet is covered by this prepare
+  int firstSlot = logFileManager.getEntryCount();
+  PayloadWriter writer;
+  writer.write(firstSlot);
+
+  std::string prepareData;
+  writer.getData(prepareData);
+
   Message prepare;
-  messenger.setMessage(ConsensusCode::PREPARE, prepare);
+  messenger.setMessage(ConsensusCode::PREPARE, prepareData, prepare);
 
   {
     std::unique_lock<std::mutex> lock(mutex);
 
     context.roundId = prepare.getId();
+    context.recovered.clear();
+
+    // the proposer promises its own round and reports its own accepted values
+    context.promiseCount = 1;
+    context.maxRoundId = std::max(context.maxRoundId, context.roundId);
+    auto ite = context.accepted.lower_bound(firstSlot);
+    context.recovered.insert(ite, context.accepted.end());
   }
 
   int clusterSize = messenger.getClusterSize();
@@ -76,118 +153,372 @@ broadcastPrepare(const Messenger& messenger,
 
 void
 broadcastPropose(const Messenger& messenger,
-                 const std::string& value,
+                 const int& slot,
+                 const ConsensusManager::Instance& instance) {
+  PayloadWriter writer;
+  writer.write(instance.roundId);
+  writer.write(slot);
+  writer.write(instance.values);
+
+  std::string proposeData;
+  writer.getData(proposeData);
+  Message propose;
+  messenger.setMessage(ConsensusCode::PROPOSE, proposeData, propose);
+
+  int clusterSize = messenger.getClusterSize();
+  messenger.broadcast(propose, 0, clusterSize, false);
+}
+
+void
+broadcastAccepted(const Messenger& messenger,
+                  const int& slot,
+                  const std::vector<std::string>& values) {
+  PayloadWriter writer;
+  writer.write(slot);
+  writer.write(values);
+
+  std::string acceptedData;
+  writer.getData(acceptedData);
+
+  Message accepted;
+  messenger.setMessage(ConsensusCode::ACCEPTED, acceptedData, accepted);
+
+  int clusterSize = messenger.getClusterSize();
+  messenger.broadcast(accepted, 0, clusterSize, false);
+}
+
+void
+receivePromises(const Messenger& messenger,
+                std::mutex& mutex,
+                std::condition_variable& quorumConditional,
+                ConsensusManager::Context& context,
+                bool& majorityPromised) {
+  auto deadline = std::chrono::high_resolution_clock::now() +
+                  std::chrono::seconds(PROMISE_WAIT_DURATION);
+
+  std::unique_lock<std::mutex> lock(mutex);
+
+  // wait for the consensus thread to receive a majority of promises or time out
+  majorityPromised = quorumConditional.wait_until(lock, deadline, [&] {
+    return hasMajority(messenger, context.promiseCount);
+  });
+}
+
+void
+waitForDecision(const int& slot,
+                std::mutex& mutex,
+                std::condition_variable& quorumConditional,
+                ConsensusManager::Context& context,
+                bool& isDecided) {
+  auto deadline = std::chrono::high_resolution_clock::now() +
+                  std::chrono::seconds(ACCEPT_WAIT_DURATION);
+
+  std::unique_lock<std::mutex> lock(mutex);
+
+  // wait for the consensus thread to receive a majority of accepts or time out
+  isDecided = quorumConditional.wait_until(
+      lock, deadline, [&] { return context.instances[slot].isDecided; });
+
+  int64_t roundId = context.instances[slot].roundId;
+  context.instances.erase(slot);
+
+  // the round was preempted or the acceptors are unreachable, phase 1 will be
+  // run again on the next proposal
+  if (isDecided == false && context.leaderRoundId == roundId) {
+    context.leaderRoundId = -1;
+  }
+
+  // a slot of the window was freed
+  quorumConditional.notify_all();
+}
+
+void
+proposeInstances(const Messenger& messenger,
+                 const std::vector<int>& slots,
                  std::mutex& mutex,
-                 ConsensusManager::Context& context) {
-  std::string proposeValue;
-  int roundId;
+                 std::condition_variable& quorumConditional,
+                 ConsensusManager::Context& context,
+                 bool& consensusReached) {
+  std::vector<ConsensusManager::Instance> instances;
 
   {
     std::unique_lock<std::mutex> lock(mutex);
-    proposeValue = context.maxAcceptedId == -1 ? value : context.acceptedValue;
-    roundId = context.roundId;
+
+    for (const int& slot : slots) {
+      instances.push_back(context.instances[slot]);
+    }
   }
 
-  nlohmann::json proposeDataJson = {{"roundId", roundId},
-                                    {"value", proposeValue}};
+  // all the proposals are sent before waiting on any of them
+  for (std::size_t i = 0; i < slots.size(); i++) {
+    broadcastPropose(messenger, slots[i], instances[i]);
+  }
 
-  const std::string& proposeData = proposeDataJson.dump();
-  Message propose;
-  messenger.setMessage(ConsensusCode::PROPOSE, proposeData, propose);
+  consensusReached = true;
+  for (std::size_t i = 0; i < slots.size(); i++) {
+    bool isDecided;
+    waitForDecision(slots[i], mutex, quorumConditional, context, isDecided);
 
-  int clusterSize = messenger.getClusterSize();
-  messenger.broadcast(propose, 0, clusterSize, false);
+    if (isDecided == true) {
+      broadcastAccepted(messenger, slots[i], instances[i].values);
+    }
+
+    consensusReached = consensusReached && isDecided;
+  }
 }
 
 void
-broadcastAccepted(const Messenger& messenger,
-                  const std::string& value,
-                  std::mutex& mutex,
-                  ConsensusManager::Context& context) {
-  int roundId;
+recoverSlots(const Messenger& messenger,
+             LogFileManager& logFileManager,
+             std::condition_variable& quorumConditional,
+             ConsensusManager::Context& context,
+             std::vector<int>& slots) {
+  int firstSlot = logFileManager.getEntryCount();
+  int lastSlot = context.recovered.empty() == true
+                     ? firstSlot - 1
+                     : context.recovered.rbegin()->first;
+
+  // values accepted under a previous leader are proposed again in their slot
+  // and the gaps in between are filled with no-ops. Slots past a decided one
+  // start a new batch since batches span consecutive slots
+  std::vector<std::string> values;
+  for (int slot = firstSlot; slot <= lastSlot + 1; slot++) {
+    bool isDecided = context.decided.count(slot) == 1 || slot > lastSlot;
+
+    if (isDecided == true && values.empty() == false) {
+      int batchSlot = slot - values.size();
+      addInstance(messenger,
+                  batchSlot,
+                  values,
+                  logFileManager,
+                  quorumConditional,
+                  context);
+      slots.push_back(batchSlot);
+      values.clear();
+    } else if (isDecided == false) {
+      auto ite = context.recovered.find(slot);
+      bool isRecovered = ite != context.recovered.end();
+      values.push_back(isRecovered == true ? ite->second.value : NOOP_VALUE);
+    }
+  }
+
+  context.nextSlot = lastSlot + 1;
+}
+
+void
+establishLeadership(const Messenger& messenger,
+                    LogFileManager& logFileManager,
+                    std::mutex& mutex,
+                    std::condition_variable& quorumConditional,
+                    ConsensusManager::Context& context) {
   {
     std::unique_lock<std::mutex> lock(mutex);
 
-    roundId = context.roundId;
+    // wait for the instances of the previous round to complete
+    quorumConditional.wait(lock, [&] {
+      return context.isPreparing == false && context.instances.empty();
+    });
+
+    // another thread already established the leadership
+    if (context.leaderRoundId != -1) {
+      return;
+    }
+
+    context.isPreparing = true;
   }
 
-  nlohmann::json acceptedDataJson = {{"roundId", roundId}, {"value", value}};
-  const std::string& acceptedData = acceptedDataJson.dump();
+  broadcastPrepare(messenger, logFileManager, mutex, context);
 
-  Message accepted;
-  messenger.setMessage(ConsensusCode::ACCEPTED, acceptedData, accepted);
+  bool majorityPromised;
+  receivePromises(
+      messenger, mutex, quorumConditional, context, majorityPromised);
 
-  int clusterSize = messenger.getClusterSize();
-  messenger.broadcast(accepted, 0, clusterSize, false);
+  std::vector<int> slots;
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (majorityPromised == true) {
+      // the promised round is kept for every following slot until another
+      // proposer preempts it
+      context.leaderRoundId = context.roundId;
+
+      recoverSlots(
+          messenger, logFileManager, quorumConditional, context, slots);
+    }
+
+    context.isPreparing = false;
+    quorumConditional.notify_all();
+  }
+
+  if (slots.empty() == false) {
+    bool consensusReached;
+    proposeInstances(
+        messenger, slots, mutex, quorumConditional, context, consensusReached);
+
+    logFileManager.commit();
+  }
 }
 
 void
-ConsensusManager::startConsensus(const std::string& value,
-                                 bool& consensusReached) {
-  consensusReached = false;
+ConsensusManager::startLeadership() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
 
-  broadcastPrepare(m_messenger, m_mutex, m_context);
+    m_context.leaderRoundId = -1;
+    m_context.isRetired = false;
+  }
 
-  bool majorityPromised;
-  receivePromises(m_messenger, m_mutex, m_context, majorityPromised);
+  establishLeadership(
+      m_messenger, m_logFileManager, m_mutex, m_quorumConditional, m_context);
+}
 
-  if (majorityPromised == true) {
-    broadcastPropose(m_messenger, value, m_mutex, m_context);
+int
+ConsensusManager::pauseProposals() {
+  std::unique_lock<std::mutex> lock(m_mutex);
 
-    bool majorityAccepted = false;
-    receiveAccepts(m_messenger, m_mutex, m_context, majorityAccepted);
+  m_context.isPaused = true;
 
-    if (majorityAccepted == true) {
-      m_logFileManager.append(value);
+  m_quorumConditional.wait(lock, [&] {
+    return m_context.isPreparing == false && m_context.instances.empty();
+  });
 
-      broadcastAccepted(m_messenger, value, m_mutex, m_context);
+  return m_logFileManager.getEntryCount();
+}
+
+void
+ConsensusManager::resumeProposals(const bool& isLeader) {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
 
-      consensusReached = true;
+    m_context.isPaused = false;
+
+    // a former leader must not run phase 1 again for the requests it still
+    // holds, as it would preempt the new leader
+    if (isLeader == false) {
+      m_context.isRetired = true;
+      m_context.leaderRoundId = -1;
     }
   }
-  
-  // wait for the consensus thread to write down the log
-  std::this_thread::sleep_for(std::chrono::seconds(LOG_WRITE_DURATION));
 
-  // reset the consensus round context
+  m_quorumConditional.notify_all();
+}
+
+bool
+ConsensusManager::waitForLog(const int& entryCount) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  return m_quorumConditional.wait_for(
+      lock, std::chrono::milliseconds(CATCH_UP_WAIT_DURATION), [&] {
+        return m_logFileManager.getEntryCount() >= entryCount;
+      });
+}
+
+void
+ConsensusManager::startConsensus(const std::vector<std::string>& values,
+                                 bool& consensusReached) {
+  consensusReached = false;
+
+  bool isLeader;
+
   {
     std::unique_lock<std::mutex> lock(m_mutex);
 
-    m_context = ConsensusManager::Context{};
+    m_quorumConditional.wait(lock, [&] {
+      return m_context.isPreparing == false && m_context.isPaused == false;
+    });
+
+    if (m_context.isRetired == true) {
+      return;
+    }
+
+    isLeader = m_context.leaderRoundId != -1;
+  }
+
+  // phase 1 is only run when no round is currently promised to this node
+  if (isLeader == false) {
+    establishLeadership(
+        m_messenger, m_logFileManager, m_mutex, m_quorumConditional, m_context);
+  }
+
+  int slot;
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // wait for a free slot in the window of in-flight proposals
+    m_quorumConditional.wait(lock, [&] {
+      return m_context.isPreparing == false && m_context.isPaused == false &&
+             (m_context.leaderRoundId == -1 ||
+              static_cast<int>(m_context.instances.size()) <
+                  m_context.windowSize);
+    });
+
+    if (m_context.leaderRoundId == -1 || m_context.isRetired == true) {
+      return;
+    }
+
+    slot = std::max(m_context.nextSlot, m_logFileManager.getEntryCount());
+    m_context.nextSlot = slot + values.size();
+
+    addInstance(m_messenger,
+                slot,
+                values,
+                m_logFileManager,
+                m_quorumConditional,
+                m_context);
+  }
+
+  proposeInstances(m_messenger,
+                   {slot},
+                   m_mutex,
+                   m_quorumConditional,
+                   m_context,
+                   consensusReached);
+
+  // the client is only answered once the log is durable
+  if (consensusReached == true) {
+    m_logFileManager.commit();
   }
 }
 
 void
 handlePrepareMessage(const Messenger& messenger,
                      const int& srcNodeId,
-                     const int& id,
-                     int& maxRoundId,
+                     const int64_t& id,
+                     const Message& receivedMessage,
                      std::mutex& mutex,
                      ConsensusManager::Context& context) {
+  PayloadReader reader(receivedMessage.getData());
+
+  int firstSlot;
+  reader.read(firstSlot);
+
   std::unique_lock<std::mutex> lock(mutex);
 
-  if (id > maxRoundId) {
-    maxRoundId = id;
+  if (id > context.maxRoundId) {
+    context.maxRoundId = id;
 
-    Message promise;
-    if (context.valueAccepted == true) {
-      nlohmann::json promiseDataJson = {
-          {"roundId", id},
-          {"acceptedId", context.acceptedId},
-          {"acceptedValue", context.acceptedValue}};
-      const std::string& promiseData = promiseDataJson.dump();
-      messenger.setMessage(ConsensusCode::PROMISE, promiseData, promise);
-
-      // send back the accepted value if a proposal was already accepted
-      messenger.send(srcNodeId, promise);
-    } else {
-      nlohmann::json promiseDataJson = {{"roundId", id}};
-      const std::string& promiseData = promiseDataJson.dump();
-      messenger.setMessage(ConsensusCode::PROMISE, promiseData, promise);
-
-      // otherwise respond with a normal promise
-      messenger.send(srcNodeId, promise);
+    auto ite = context.accepted.lower_bound(firstSlot);
+
+    PayloadWriter writer;
+    writer.write(id);
+    writer.write(static_cast<int>(std::distance(ite, context.accepted.end())));
+
+    // send back the values accepted in the slots covered by the prepare
+    for (; ite != context.accepted.end(); ite++) {
+      writer.write(ite->first);
+      writer.write(ite->second.acceptedId);
+      writer.write(ite->second.value);
     }
+
+    std::string promiseData;
+    writer.getData(promiseData);
+
+    Message promise;
+    messenger.setMessage(ConsensusCode::PROMISE, promiseData, promise);
+
+    messenger.send(srcNodeId, promise);
   }
 }
 
@@ -195,26 +526,37 @@ void
 handleProposeMessage(const Messenger& messenger,
                      const int& srcNodeId,
                      const Message& receivedMessage,
-                     const int& id,
-                     const int& maxRoundId,
                      std::mutex& mutex,
                      ConsensusManager::Context& context) {
+  PayloadReader reader(receivedMessage.getData());
+
+  int64_t roundId;
+  int slot;
+  std::vector<std::string> values;
+  reader.read(roundId);
+  reader.read(slot);
+  reader.read(values);
+
   std::unique_lock<std::mutex> lock(mutex);
 
-  const std::string& messageData = receivedMessage.getData();
-  nlohmann::json messageJson = nlohmann::json::parse(messageData);
+  // a stable leader keeps proposing under the round promised in its last
+  // phase 1, so any round not older than the promised one is accepted
+  if (roundId >= context.maxRoundId) {
+    context.maxRoundId = roundId;
 
-  int roundId = messageJson.at("roundId");
-  if (roundId == maxRoundId) {
-    context.valueAccepted = true;
-    context.acceptedId = roundId;
+    // every slot of the batch is accepted individually
+    for (std::size_t i = 0; i < values.size(); i++) {
+      context.accepted[slot + i] = {roundId, values[i]};
+    }
 
-    std::string value = messageJson.at("value");
-    context.acceptedValue = value;
+    PayloadWriter writer;
+    writer.write(roundId);
+    writer.write(slot);
+
+    std::string acceptData;
+    writer.getData(acceptData);
 
     Message accept;
-    nlohmann::json acceptDataJson = {{"roundId", id}};
-    const std::string& acceptData = acceptDataJson.dump();
 
     messenger.setMessage(ConsensusCode::ACCEPT, acceptData, accept);
 
@@ -224,95 +566,132 @@ handleProposeMessage(const Messenger& messenger,
 }
 
 void
-handleAcceptedMessage(const Messenger& messenger,
-                      const Message& receivedMessage,
+handleAcceptedMessage(const Message& receivedMessage,
                       LogFileManager& logFileManager,
                       std::mutex& mutex,
+                      std::condition_variable& quorumConditional,
                       ConsensusManager::Context& context) {
-  const std::string& messageData = receivedMessage.getData();
-  nlohmann::json messageJson = nlohmann::json::parse(messageData);
-
-  std::string value = messageJson.at("value");
+  PayloadReader reader(receivedMessage.getData());
 
-  // write down the value to the log
-  logFileManager.append(value);
+  int slot;
+  std::vector<std::string> values;
+  reader.read(slot);
+  reader.read(values);
 
   {
     std::unique_lock<std::mutex> lock(mutex);
-    context = ConsensusManager::Context{};
+
+    // write down the values to the log once all the previous slots are written
+    learnValues(slot, values, logFileManager, context);
   }
+
+  // wake a node waiting to catch up with the leader
+  quorumConditional.notify_all();
+
+  logFileManager.commit();
 }
 
 void
 handlePromiseMessage(const Message& promise,
                      std::mutex& mutex,
+                     std::condition_variable& quorumConditional,
                      ConsensusManager::Context& context) {
-  const std::string& messageData = promise.getData();
-  nlohmann::json messageJson = nlohmann::json::parse(messageData);
+  PayloadReader reader(promise.getData());
 
-  int id = messageJson.at("roundId");
+  int64_t id;
+  int acceptedCount;
+  reader.read(id);
+  reader.read(acceptedCount);
 
   {
     std::unique_lock<std::mutex> lock(mutex);
 
     if (id == context.roundId) {
-      int acceptedId = messageJson.value("acceptedId", -1);
-
-      if (acceptedId > context.maxAcceptedId) {
-        context.acceptedValue = messageJson.value("acceptedValue", "");
-        context.maxAcceptedId = acceptedId;
+      // keep the value accepted in the highest round of each slot
+      for (int i = 0; i < acceptedCount && reader.getIsValid() == true; i++) {
+        int slot;
+        int64_t acceptedId;
+        std::string value;
+        reader.read(slot);
+        reader.read(acceptedId);
+        reader.read(value);
+
+        ConsensusManager::AcceptedValue& recovered = context.recovered[slot];
+        if (acceptedId > recovered.acceptedId) {
+          recovered.acceptedId = acceptedId;
+          recovered.value = value;
+        }
       }
 
-      // increase the accept count. Checked on the thread that started consensus
+      // increase the promise count and wake the thread that started consensus
       context.promiseCount += 1;
+      quorumConditional.notify_all();
     }
   }
 }
 
 void
-handleAcceptMessage(const Message& accept,
+handleAcceptMessage(const Messenger& messenger,
+                    const Message& accept,
+                    LogFileManager& logFileManager,
                     std::mutex& mutex,
+                    std::condition_variable& quorumConditional,
                     ConsensusManager::Context& context) {
+  PayloadReader reader(accept.getData());
+
+  int64_t id;
+  int slot;
+  reader.read(id);
+  reader.read(slot);
+
   std::unique_lock<std::mutex> lock(mutex);
 
-  // increase the accept count. Checked on the thread that started consensus
-  context.acceptCount += 1;
+  // ignore late accepts of a completed instance or a previous round
+  auto ite = context.instances.find(slot);
+  if (ite != context.instances.end() && ite->second.roundId == id) {
+    ite->second.acceptCount += 1;
+
+    updateDecision(messenger, slot, logFileManager, quorumConditional, context);
+  }
 }
 
 void
 ConsensusManager::handleMessage(const int& srcNodeId,
                                 const Message& receivedMessage,
                                 const Messenger::Connection& connection) {
-  int clusterSize = m_messenger.getClusterSize();
   ConsensusCode code = receivedMessage.getCode<ConsensusCode>();
-  int id = receivedMessage.getId();
+  int64_t id = receivedMessage.getId();
   switch (code) {
   case ConsensusCode::PREPARE: {
     handlePrepareMessage(
-        m_messenger, srcNodeId, id, m_maxRoundId, m_mutex, m_context);
+        m_messenger, srcNodeId, id, receivedMessage, m_mutex, m_context);
     break;
   }
   case ConsensusCode::PROMISE: {
-    handlePromiseMessage(receivedMessage, m_mutex, m_context);
+    handlePromiseMessage(
+        receivedMessage, m_mutex, m_quorumConditional, m_context);
     break;
   }
   case ConsensusCode::PROPOSE: {
-    handleProposeMessage(m_messenger,
-                         srcNodeId,
-                         receivedMessage,
-                         id,
-                         m_maxRoundId,
-                         m_mutex,
-                         m_context);
+    handleProposeMessage(
+        m_messenger, srcNodeId, receivedMessage, m_mutex, m_context);
     break;
   }
   case ConsensusCode::ACCEPT: {
-    handleAcceptMessage(receivedMessage, m_mutex, m_context);
+    handleAcceptMessage(m_messenger,
+                        receivedMessage,
+                        m_logFileManager,
+                        m_mutex,
+                        m_quorumConditional,
+                        m_context);
     break;
   }
   case ConsensusCode::ACCEPTED: {
-    handleAcceptedMessage(
-        m_messenger, receivedMessage, m_logFileManager, m_mutex, m_context);
+    handleAcceptedMessage(receivedMessage,
+                          m_logFileManager,
+                          m_mutex,
+                          m_quorumConditional,
+                          m_context);
     break;
   }
   }
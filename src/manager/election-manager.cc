@@ -1,180 +1,816 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <random>
 
 #include "client-manager.hh"
+#include "consensus-manager.hh"
 #include "election-manager.hh"
 #include "message-info.hh"
 #include "receiver-manager.hh"
+#include "payload.hh"
 
 #define ELECTION_WAIT_DURATION 2
-#define LOOP_SLEEP_DURATION 10
+#define RAFT_TIMEOUT_MIN 150
+#define RAFT_TIMEOUT_MAX 300
+#define RAFT_TIMEOUT_BANDS 3
+#define PROBE_TIMEOUT 500
+#define PROBE_ROUND_COUNT 5
+#define SCORE_SCALE 1000000
+#define TRANSFER_WAIT_DURATION 1000
 
 // Note: The comments in the file were taken from the
 // https://en.wikipedia.org/wiki/Bully_algorithm wikipedia page.
 
 ElectionManager::ElectionManager(
-    Messenger& messenger, std::shared_ptr<ReceiverManager> receiverManager)
-    : MessageReceiver(messenger, managedTag, receiverManager) {
+    Messenger& messenger,
+    std::shared_ptr<ReceiverManager> receiverManager,
+    const ElectionMode& mode,
+    const int& cpuClass,
+    const int64_t& appendLatency)
+    : MessageReceiver(messenger, managedTag, receiverManager),
+      m_mode(mode),
+      m_cpuClass(cpuClass),
+      m_appendLatency(appendLatency) {
 }
 
-void
-broadcastElection(Messenger& messenger,
-                  std::mutex& mutex,
-                  int& leaderNodeId,
-                  timePoint& start,
-                  bool& aliveReceived) {
-  {
-    std::unique_lock<std::mutex> lock(mutex);
+// the node with the highest capability score is preferred, the highest id
+// breaks ties as in the original bully algorithm
+bool
+isPreferred(const std::vector<int64_t>& scores,
+            const int& nodeId,
+            const int& otherNodeId) {
+  return scores[nodeId] > scores[otherNodeId] ||
+         (scores[nodeId] == scores[otherNodeId] && nodeId > otherNodeId);
+}
 
-    aliveReceived = false;
-    leaderNodeId = -1;
-    start = std::chrono::high_resolution_clock::now();
-  }
+void
+sendScore(const Messenger& messenger,
+          const int& dstNodeId,
+          const LeaderElectionCode& code,
+          const int64_t& score) {
+  PayloadWriter writer;
+  writer.write(score);
 
-  Message electionMessage;
-  messenger.setMessage(LeaderElectionCode::ELECTION, electionMessage);
+  std::string data;
+  writer.moveData(data);
 
-  int nodeId = messenger.getRank();
+  Message message;
+  messenger.setMessage(code, message);
+  message.setData(std::move(data));
 
-  messenger.broadcast(electionMessage, nodeId + 1);
+  messenger.send(dstNodeId, message);
 }
 
-void
-setLeaderNodeId(const int& value, std::mutex& mutex, int& leaderNodeId) {
-  std::unique_lock<std::mutex> lock(mutex);
+// returns the score carried by the message, or -1 if it has none
+int64_t
+readScore(const Message& receivedMessage,
+          const int& srcNodeId,
+          ElectionManager::Context& context) {
+  PayloadReader reader(receivedMessage.getData());
+
+  int64_t score;
+  reader.read(score);
+
+  if (reader.getIsValid() == true) {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    context.scores[srcNodeId] = score;
+  }
 
-  leaderNodeId = value;
+  return reader.getIsValid() == true ? score : -1;
 }
 
+// returns whether a thread already waits for the outcome of the election
 bool
-gotLeader(std::mutex& mutex, const int& leaderNodeId) {
-  std::unique_lock<std::mutex> lock(mutex);
+broadcastElection(Messenger& messenger, ElectionManager::Context& context) {
+  int nodeId = messenger.getRank();
+  bool isElecting;
+  int64_t score;
+  std::vector<int> dstNodeIds;
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    context.aliveReceived = false;
+    context.leaderNodeId = -1;
+    context.deadline = std::chrono::high_resolution_clock::now() +
+                       std::chrono::seconds(ELECTION_WAIT_DURATION);
+
+    isElecting = context.isElecting;
+    context.isElecting = true;
+
+    // the election is sent to the nodes scoring higher, and to the ones whose
+    // score is not known yet
+    score = context.scores[nodeId];
+    for (int i = 0; i < messenger.getClusterSize(); i++) {
+      if (i != nodeId && (context.scores[i] == -1 ||
+                          isPreferred(context.scores, i, nodeId) == true)) {
+        dstNodeIds.push_back(i);
+      }
+    }
+  }
+
+  context.conditional.notify_all();
+
+  for (const int& dstNodeId : dstNodeIds) {
+    sendScore(messenger, dstNodeId, LeaderElectionCode::ELECTION, score);
+  }
 
-  return leaderNodeId != -1;
+  return isElecting;
 }
 
 void
-declareVictory(const Messenger& messenger,
-               std::mutex& mutex,
-               int& leaderNodeId) {
+declareVictory(const Messenger& messenger, ElectionManager::Context& context) {
+  int nodeId = messenger.getRank();
+  int64_t term;
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    context.leaderNodeId = nodeId;
+    term = context.term;
+  }
+
+  context.conditional.notify_all();
+
+  // the term is always 0 with the bully algorithm
+  PayloadWriter writer;
+  writer.write(term);
+
+  std::string data;
+  writer.moveData(data);
+
   Message victoryMessage;
   messenger.setMessage(LeaderElectionCode::VICTORY, victoryMessage);
+  victoryMessage.setData(std::move(data));
 
   int clusterSize = messenger.getClusterSize();
   messenger.broadcast(victoryMessage, 0, clusterSize, false);
+}
 
-  int nodeId = messenger.getRank();
-  setLeaderNodeId(nodeId, mutex, leaderNodeId);
+void
+startLeadership(std::shared_ptr<ReceiverManager>& receiverManager) {
+  // run phase 1 once for all the instances proposed during this leadership
+  std::shared_ptr<ConsensusManager> consensusManager =
+      receiverManager->getReceiver<ConsensusManager>();
+
+  consensusManager->startLeadership();
+
+  std::shared_ptr<ClientManager> clientManager =
+      receiverManager->getReceiver<ClientManager>();
+
+  clientManager->enableClientConn();
+}
+
+void
+printLeader(const Messenger& messenger, ElectionManager::Context& context) {
+  int leaderNodeId;
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    leaderNodeId = context.leaderNodeId;
+  }
+
+  std::string str("leader elected: ");
+  str.append(std::to_string(leaderNodeId));
+  print::printString(messenger.getRank(), str);
 }
 
 void
 waitForVictory(Messenger& messenger,
-               std::mutex& mutex,
-               int& leaderNodeId,
-               bool& aliveReceived,
-               timePoint& start,
-               std::shared_ptr<ReceiverManager>& receiverManager) {
-  using namespace std::chrono;
-  auto cur = high_resolution_clock::now();
-  int elapsed = 0;
+               ElectionManager::Context& context,
+               std::shared_ptr<ReceiverManager> receiverManager) {
+  bool isDone = false;
+  while (isDone == false) {
+    bool gotLeader;
+    bool isRestarted;
 
-  bool keepWaiting = true;
-  while (keepWaiting == true) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(LOOP_SLEEP_DURATION));
+    {
+      std::unique_lock<std::mutex> lock(context.mutex);
+
+      // wait until a leader is elected or the election times out, the
+      // deadline is read again on every wake up as an answer from a higher
+      // id'd node pushes it back
+      while (context.leaderNodeId == -1 &&
+             std::chrono::high_resolution_clock::now() < context.deadline) {
+        context.conditional.wait_until(lock, context.deadline);
+      }
+
+      gotLeader = context.leaderNodeId != -1;
+      isRestarted = gotLeader == false && context.aliveReceived == true;
+      isDone = isRestarted == false;
+
+      if (isDone == true) {
+        context.isElecting = false;
+      }
+    }
+
+    if (isRestarted == true) {
+      // If there is no Victory message after a period of time, it restarts the
+      // process at the beginning.
+      broadcastElection(messenger, context);
+    } else if (gotLeader == false) {
+      // If P receives no Answer after sending an Election message, then it
+      // broadcasts a Victory message to all other processes and becomes the
+      // Coordinator.
+      declareVictory(messenger, context);
+      startLeadership(receiverManager);
+    }
+  }
+
+  printLeader(messenger, context);
+}
+
+// the nodes draw their timeouts at random so that they rarely stand for
+// election at the same time. The timeouts of the nodes scoring higher are
+// drawn from earlier bands so that they usually stand first
+std::chrono::milliseconds
+getRandomTimeout(const std::vector<int64_t>& scores, const int& nodeId) {
+  thread_local std::mt19937 generator(std::random_device{}());
+  std::uniform_int_distribution<int> distribution(RAFT_TIMEOUT_MIN,
+                                                  RAFT_TIMEOUT_MAX);
+
+  int band = 0;
+  for (int i = 0; i < static_cast<int>(scores.size()); i++) {
+    band += i != nodeId && isPreferred(scores, i, nodeId) == true ? 1 : 0;
+  }
+
+  band = std::min(band, RAFT_TIMEOUT_BANDS - 1);
+
+  return std::chrono::milliseconds(
+      band * (RAFT_TIMEOUT_MAX - RAFT_TIMEOUT_MIN) + distribution(generator));
+}
+
+// returns whether a thread already waits for the outcome of the election
+bool
+resetTimeout(ElectionManager::Context& context, const int& nodeId) {
+  bool isElecting;
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
 
-    cur = high_resolution_clock::now();
+    context.leaderNodeId = -1;
+    context.voteCount = 0;
+    context.deadline = std::chrono::high_resolution_clock::now() +
+                       getRandomTimeout(context.scores, nodeId);
+
+    isElecting = context.isElecting;
+    context.isElecting = true;
+  }
+
+  context.conditional.notify_all();
+
+  return isElecting;
+}
+
+void
+requestVotes(const Messenger& messenger,
+             const int64_t& term,
+             const int64_t& score) {
+  PayloadWriter writer;
+  writer.write(term);
+  writer.write(score);
+
+  std::string data;
+  writer.moveData(data);
+
+  Message message;
+  messenger.setMessage(LeaderElectionCode::REQUEST_VOTE, message);
+  message.setData(std::move(data));
+
+  int clusterSize = messenger.getClusterSize();
+  messenger.broadcast(message, 0, clusterSize, false);
+}
+
+void
+waitForVotes(Messenger& messenger,
+             ElectionManager::Context& context,
+             std::shared_ptr<ReceiverManager> receiverManager) {
+  int nodeId = messenger.getRank();
+  int quorum = messenger.getClusterSize() / 2 + 1;
+
+  bool isDone = false;
+  while (isDone == false) {
+    bool isElected;
+    int64_t term;
+    int64_t score;
 
     {
-      std::unique_lock<std::mutex> lock(mutex);
+      std::unique_lock<std::mutex> lock(context.mutex);
+
+      // wait until a leader is elected, a majority voted for this node or the
+      // timeout passes. Granting a vote pushes the deadline back
+      while (context.leaderNodeId == -1 && context.voteCount < quorum &&
+             std::chrono::high_resolution_clock::now() < context.deadline) {
+        context.conditional.wait_until(lock, context.deadline);
+      }
+
+      isElected = context.leaderNodeId == -1 && context.voteCount >= quorum;
+      isDone = context.leaderNodeId != -1 || isElected == true;
+
+      if (isDone == true) {
+        context.isElecting = false;
+      } else {
+        // no leader was heard of before the timeout, stand for election in a
+        // new term
+        context.term++;
+        context.votedFor = nodeId;
+        context.voteCount = 1;
+        context.deadline = std::chrono::high_resolution_clock::now() +
+                           getRandomTimeout(context.scores, nodeId);
+      }
+
+      term = context.term;
+      score = context.scores[nodeId];
+    }
+
+    if (isElected == true) {
+      declareVictory(messenger, context);
+      startLeadership(receiverManager);
+    } else if (isDone == false) {
+      requestVotes(messenger, term, score);
+    }
+  }
+
+  printLeader(messenger, context);
+}
+
+// returns whether the election timeout of this node must be reset
+bool
+handleRequestVote(const int& srcNodeId,
+                  const Message& receivedMessage,
+                  const Messenger& messenger,
+                  ElectionManager::Context& context) {
+  PayloadReader reader(receivedMessage.getData());
+
+  int64_t term;
+  int64_t score;
+  reader.read(term);
+  reader.read(score);
+
+  if (reader.getIsValid() == false) {
+    return false;
+  }
+
+  int nodeId = messenger.getRank();
+  bool isNewTerm;
+  bool isGranted;
+  int64_t currentTerm;
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    // the leader is only dropped once the failure detection of this node
+    // suspects it, the candidates suspecting it wrongly are ignored and do not
+    // force the other nodes into a new election
+    bool hasLeader =
+        context.leaderNodeId != -1 && context.leaderNodeId != srcNodeId;
+
+    // a higher term ends the current one along with its leader or candidacy
+    isNewTerm = hasLeader == false && term > context.term;
+    if (isNewTerm == true) {
+      context.term = term;
+      context.votedFor = -1;
+      context.voteCount = 0;
+    }
 
-      elapsed = duration_cast<std::chrono::seconds>(cur - start).count();
+    context.scores[srcNodeId] = score;
 
-      // if an answer from a higher id'd node is received it wait for a given
-      // amount of time otherwise wait until a leader is elected or the election
-      // times out.
-      keepWaiting = (aliveReceived == true) ||
-                    (leaderNodeId == -1) && (elapsed < ELECTION_WAIT_DURATION);
+    // a single vote is granted per term, to a node scoring higher than this
+    // one. No vote is granted before this node measured its own score
+    isGranted = hasLeader == false && term == context.term &&
+                (context.votedFor == -1 || context.votedFor == srcNodeId) &&
+                context.scores[nodeId] != -1 &&
+                isPreferred(context.scores, srcNodeId, nodeId) == true;
+    if (isGranted == true) {
+      context.votedFor = srcNodeId;
     }
+
+    currentTerm = context.term;
   }
 
-  // If P receives no Answer after sending an Election message, then it
-  // broadcasts a Victory message to all other processes and becomes the
-  // Coordinator.
-  if (gotLeader(mutex, leaderNodeId) == false) {
-    declareVictory(messenger, mutex, leaderNodeId);
+  PayloadWriter writer;
+  writer.write(currentTerm);
+  writer.write(static_cast<int>(isGranted));
+
+  std::string data;
+  writer.moveData(data);
+
+  Message message;
+  messenger.setMessage(LeaderElectionCode::VOTE, message);
+  message.setData(std::move(data));
+
+  messenger.send(srcNodeId, message);
+
+  return isNewTerm == true || isGranted == true;
+}
+
+void
+handleVote(const Message& receivedMessage, ElectionManager::Context& context) {
+  PayloadReader reader(receivedMessage.getData());
 
-    std::shared_ptr<ClientManager> clientManager =
-        receiverManager->getReceiver<ClientManager>();
+  int64_t term;
+  int isGranted;
+  reader.read(term);
+  reader.read(isGranted);
 
-    clientManager->enableClientConn();
+  if (reader.getIsValid() == false) {
+    return;
   }
 
-  std::string str("leader elected: ");
-  str.append(std::to_string(leaderNodeId));
-  print::printString(messenger.getRank(), str);
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    if (term > context.term) {
+      context.term = term;
+      context.votedFor = -1;
+      context.voteCount = 0;
+    } else if (term == context.term && context.voteCount > 0 &&
+               isGranted == 1) {
+      context.voteCount++;
+    }
+  }
+
+  context.conditional.notify_all();
 }
 
 void
-triggerElection(Messenger& messenger,
-                std::mutex& mutex,
-                int& leaderNodeId,
-                bool& aliveReceived,
-                timePoint& start,
-                std::shared_ptr<ReceiverManager> receiverManager) {
-  broadcastElection(messenger, mutex, leaderNodeId, start, aliveReceived);
+handleVictory(const int& srcNodeId,
+              const Message& receivedMessage,
+              ElectionManager::Context& context) {
+  PayloadReader reader(receivedMessage.getData());
 
-  waitForVictory(
-      messenger, mutex, leaderNodeId, aliveReceived, start, receiverManager);
+  int64_t term;
+  reader.read(term);
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    // the victory sent to a recovered node carries no term, the leader of a
+    // past term is ignored
+    bool hasTerm = reader.getIsValid() == true;
+    if (hasTerm == false || term >= context.term) {
+      context.term = hasTerm == true ? term : context.term;
+      context.leaderNodeId = srcNodeId;
+      context.voteCount = 0;
+    }
+  }
+
+  context.conditional.notify_all();
 }
 
+// measures the capability score of this node before the first election
 void
-ElectionManager::startElection() {
-  std::thread triggerThread = std::thread(triggerElection,
-                                          std::ref(m_messenger),
-                                          std::ref(m_mutex),
-                                          std::ref(m_leaderNodeId),
-                                          std::ref(m_aliveReceived),
-                                          std::ref(m_start),
-                                          std::ref(m_receiverManager));
-  triggerThread.detach();
+measureScore(Messenger& messenger,
+             ElectionManager::Context& context,
+             const int& cpuClass,
+             const int64_t& appendLatency,
+             std::shared_ptr<ReceiverManager> receiverManager) {
+  int nodeId = messenger.getRank();
+  int peerCount = messenger.getClusterSize() - 1;
+
+  // a node whose receive loop was not started yet answers the first round
+  // late. The round trip of a node is the shortest of its answers, so the
+  // probe is sent again until a round is answered in full by every node, or
+  // the rounds run out as some nodes are down
+  bool isComplete = false;
+  for (int round = 0; round < PROBE_ROUND_COUNT && isComplete == false;
+       round++) {
+    {
+      std::unique_lock<std::mutex> lock(context.mutex);
+
+      context.probeStart = std::chrono::high_resolution_clock::now();
+      context.probeRound = round;
+      context.probeCount = 0;
+    }
+
+    PayloadWriter writer;
+    writer.write(round);
+
+    std::string data;
+    writer.moveData(data);
+
+    Message probe;
+    messenger.setMessage(LeaderElectionCode::PROBE, probe);
+    probe.setData(std::move(data));
+
+    messenger.broadcast(probe, 0, messenger.getClusterSize(), false);
+
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    context.conditional.wait_for(
+        lock, std::chrono::milliseconds(PROBE_TIMEOUT), [&] {
+          return context.probeCount == peerCount;
+        });
+
+    isComplete = round > 0 && context.probeCount == peerCount;
+  }
+
+  int64_t roundTrip;
+  int64_t score;
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    context.probeRound = -1;
+
+    // the nodes which never answered are down, they take no part in the
+    // elections for now
+    int64_t roundTripSum = 0;
+    int answerCount = 0;
+    for (const int64_t& nodeRoundTrip : context.roundTrips) {
+      if (nodeRoundTrip != -1) {
+        roundTripSum += nodeRoundTrip;
+        answerCount++;
+      }
+    }
+
+    roundTrip = answerCount > 0 ? roundTripSum / answerCount
+                                : static_cast<int64_t>(PROBE_TIMEOUT) * 1000;
+
+    // an estimate of the requests per second the node would serve as a leader
+    score = cpuClass * SCORE_SCALE / (1 + roundTrip + appendLatency);
+    context.scores[nodeId] = score;
+  }
+
+  std::string str("capability score: ");
+  str.append(std::to_string(score));
+  str.append(" (round trip ");
+  str.append(std::to_string(roundTrip));
+  str.append("us, append ");
+  str.append(std::to_string(appendLatency));
+  str.append("us)");
+  print::printString(nodeId, str);
+
+  std::shared_ptr<ElectionManager> electionManager =
+      receiverManager->getReceiver<ElectionManager>();
+
+  electionManager->startElection();
 }
 
+// the answers to the rounds of the probe that are over are dropped
 void
-ElectionManager::init() {
-  this->startElection();
+handleProbeAck(const int& srcNodeId,
+               const Message& receivedMessage,
+               ElectionManager::Context& context) {
+  PayloadReader reader(receivedMessage.getData());
+
+  int round;
+  reader.read(round);
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    if (reader.getIsValid() == false || round != context.probeRound) {
+      return;
+    }
+
+    using namespace std::chrono;
+    auto cur = high_resolution_clock::now();
+    int64_t roundTrip =
+        duration_cast<microseconds>(cur - context.probeStart).count();
+
+    int64_t& nodeRoundTrip = context.roundTrips[srcNodeId];
+    if (nodeRoundTrip == -1 || roundTrip < nodeRoundTrip) {
+      nodeRoundTrip = roundTrip;
+    }
+
+    context.probeCount++;
+  }
+
+  context.conditional.notify_all();
+}
+
+// returns whether the given node took the leadership over
+bool
+handOver(Messenger& messenger,
+         ElectionManager::Context& context,
+         std::shared_ptr<ReceiverManager> receiverManager,
+         const int& dstNodeId) {
+  int nodeId = messenger.getRank();
+  int64_t term;
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    // the leader hands its leadership over to a single node at a time
+    if (context.leaderNodeId != nodeId || context.transferNodeId != -1 ||
+        dstNodeId == nodeId) {
+      return false;
+    }
+
+    context.transferNodeId = dstNodeId;
+    term = context.term;
+  }
+
+  std::shared_ptr<ConsensusManager> consensusManager =
+      receiverManager->getReceiver<ConsensusManager>();
+
+  // the node takes over once its log holds the values proposed so far
+  int entryCount = consensusManager->pauseProposals();
+
+  PayloadWriter writer;
+  writer.write(entryCount);
+  writer.write(term);
+
+  std::string data;
+  writer.moveData(data);
+
+  Message handoverMessage;
+  messenger.setMessage(LeaderElectionCode::HANDOVER, handoverMessage);
+  handoverMessage.setData(std::move(data));
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    context.handoverId = handoverMessage.getId();
+  }
+
+  messenger.send(dstNodeId, handoverMessage);
+
+  bool isTransferred;
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    context.conditional.wait_for(
+        lock, std::chrono::milliseconds(TRANSFER_WAIT_DURATION), [&] {
+          return context.leaderNodeId != nodeId;
+        });
+
+    // a go ahead asked for from now on is refused
+    isTransferred = context.leaderNodeId != nodeId;
+    context.transferNodeId = -1;
+    context.handoverId = -1;
+  }
+
+  consensusManager->resumeProposals(isTransferred == false);
+
+  std::string str(isTransferred == true ? "leadership transferred to: "
+                                        : "leadership transfer failed: ");
+  str.append(std::to_string(dstNodeId));
+  print::printString(nodeId, str);
+
+  return isTransferred;
+}
+
+// gives the go ahead to the node taking the leadership over if the leader still
+// waits for it
+void
+handleTakeOver(const int& srcNodeId,
+               const Message& receivedMessage,
+               const Messenger& messenger,
+               ElectionManager::Context& context) {
+  PayloadReader reader(receivedMessage.getData());
+
+  int64_t handoverId;
+  reader.read(handoverId);
+
+  int nodeId = messenger.getRank();
+  bool isAccepted;
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    isAccepted = reader.getIsValid() == true &&
+                 context.leaderNodeId == nodeId &&
+                 context.transferNodeId == srcNodeId &&
+                 context.handoverId == handoverId;
+
+    // the leader steps down before the node declares its victory
+    if (isAccepted == true) {
+      context.leaderNodeId = srcNodeId;
+    }
+  }
+
+  if (isAccepted == true) {
+    context.conditional.notify_all();
+
+    Message ackMessage;
+    messenger.setMessage(LeaderElectionCode::TAKE_OVER_ACK, ackMessage);
+    ackMessage.setData(receivedMessage.getData());
+
+    messenger.send(srcNodeId, ackMessage);
+  }
 }
 
+// declares the victory of this node once the leader handing its leadership
+// over stepped down
 void
-respondAlive(const Messenger& messenger, const int& srcNodeId) {
-  Message aliveMessage;
-  messenger.setMessage(LeaderElectionCode::ALIVE, aliveMessage);
+completeTakeOver(Messenger& messenger,
+                 ElectionManager::Context& context,
+                 std::shared_ptr<ReceiverManager> receiverManager,
+                 const ElectionMode& mode,
+                 const int64_t& handoverId,
+                 const int64_t& term) {
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    // a go ahead is acted upon once
+    if (context.takeOverId == handoverId) {
+      return;
+    }
+
+    context.takeOverId = handoverId;
+
+    // with the raft mode the new leader starts a term of its own so that the
+    // other nodes accept its victory
+    if (mode == ElectionMode::RAFT) {
+      context.term = std::max(context.term, term) + 1;
+      context.votedFor = messenger.getRank();
+    }
+  }
+
+  declareVictory(messenger, context);
+  startLeadership(receiverManager);
 
-  messenger.send(srcNodeId, aliveMessage);
+  printLeader(messenger, context);
 }
 
 void
-setAliveReceived(const bool& value, std::mutex& mutex, bool& aliveReceived) {
-  std::unique_lock<std::mutex> lock(mutex);
+takeOver(Messenger& messenger,
+         std::shared_ptr<ReceiverManager> receiverManager,
+         const int& leaderNodeId,
+         const int64_t& handoverId,
+         const int& entryCount,
+         const int64_t& term) {
+  std::shared_ptr<ConsensusManager> consensusManager =
+      receiverManager->getReceiver<ConsensusManager>();
+
+  // the entries decided by the leader reach this node with the last accepted
+  // messages, the leader keeps its leadership if they do not arrive in time
+  if (consensusManager->waitForLog(entryCount) == false) {
+    print::printString(messenger.getRank(), "leadership handover refused");
+    return;
+  }
+
+  // the leader only lets the handover through while it waits for this node,
+  // past that point it leads again and never answers
+  PayloadWriter writer;
+  writer.write(handoverId);
+  writer.write(term);
+
+  std::string data;
+  writer.moveData(data);
+
+  Message takeOverMessage;
+  messenger.setMessage(LeaderElectionCode::TAKE_OVER, takeOverMessage);
+  takeOverMessage.setData(std::move(data));
 
-  aliveReceived = value;
+  messenger.send(leaderNodeId, takeOverMessage);
 }
 
 void
-aliveWait(Messenger& messenger,
-          std::mutex& mutex,
-          bool& aliveReceived,
-          int& leaderNodeId,
-          timePoint& start) {
-  setAliveReceived(true, mutex, aliveReceived);
+ElectionManager::startElection() {
+  bool isElecting = m_mode == ElectionMode::RAFT
+                        ? resetTimeout(m_context, m_messenger.getRank())
+                        : broadcastElection(m_messenger, m_context);
+
+  // a single thread waits for the outcome, an election started while it waits
+  // only resets the deadline
+  if (isElecting == false) {
+    std::thread waitThread =
+        m_mode == ElectionMode::RAFT ? std::thread(waitForVotes,
+                                                   std::ref(m_messenger),
+                                                   std::ref(m_context),
+                                                   m_receiverManager)
+                                     : std::thread(waitForVictory,
+                                                   std::ref(m_messenger),
+                                                   std::ref(m_context),
+                                                   m_receiverManager);
+    waitThread.detach();
+  }
+}
 
-  std::this_thread::sleep_for(std::chrono::seconds(ELECTION_WAIT_DURATION * 2));
+void
+ElectionManager::init() {
+  m_context.scores.assign(m_messenger.getClusterSize(), -1);
+  m_context.roundTrips.assign(m_messenger.getClusterSize(), -1);
+
+  // the answers to the probe are handled by the receive loop, which starts once
+  // this function returns
+  std::thread scoreThread = std::thread(measureScore,
+                                        std::ref(m_messenger),
+                                        std::ref(m_context),
+                                        m_cpuClass,
+                                        m_appendLatency,
+                                        m_receiverManager);
+  scoreThread.detach();
+}
 
-  if (gotLeader(mutex, leaderNodeId) == false) {
-    broadcastElection(messenger, mutex, leaderNodeId, start, aliveReceived);
+void
+handleAlive(ElectionManager::Context& context) {
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    context.aliveReceived = true;
+    context.deadline = std::chrono::high_resolution_clock::now() +
+                       std::chrono::seconds(ELECTION_WAIT_DURATION * 2);
   }
 
-  setAliveReceived(false, mutex, aliveReceived);
+  context.conditional.notify_all();
 }
 
 void
@@ -189,9 +825,27 @@ ElectionManager::handleMessage(const int& srcNodeId,
     // if P receives an Election message from another process with a lower ID it
     // sends an Answer message back and starts the election process at the
     // beginning, by sending an Election message to higher-numbered processes.
-    respondAlive(m_messenger, srcNodeId);
-    broadcastElection(
-        m_messenger, m_mutex, m_leaderNodeId, m_start, m_aliveReceived);
+    // The capability scores take the place of the ids
+    readScore(receivedMessage, srcNodeId, m_context);
+
+    bool isHigher;
+    int64_t score;
+
+    {
+      std::unique_lock<std::mutex> lock(m_context.mutex);
+
+      score = m_context.scores[nodeId];
+      isHigher = isPreferred(m_context.scores, nodeId, srcNodeId);
+    }
+
+    // a node still measuring its score answers as well, it stands for election
+    // once measured
+    if (score == -1) {
+      sendScore(m_messenger, srcNodeId, LeaderElectionCode::ALIVE, score);
+    } else if (isHigher == true) {
+      sendScore(m_messenger, srcNodeId, LeaderElectionCode::ALIVE, score);
+      this->startElection();
+    }
     break;
   }
   case LeaderElectionCode::ALIVE: {
@@ -199,21 +853,109 @@ ElectionManager::handleMessage(const int& srcNodeId,
     // further messages for this election and waits for a Victory message. (If
     // there is no Victory message after a period of time, it restarts the
     // process at the beginning.)
-    if (srcNodeId > nodeId) {
-      std::thread aliveWaitThread = std::thread(aliveWait,
-                                                std::ref(m_messenger),
-                                                std::ref(m_mutex),
-                                                std::ref(m_aliveReceived),
-                                                std::ref(m_leaderNodeId),
-                                                std::ref(m_start));
-      aliveWaitThread.detach();
-    }
+    readScore(receivedMessage, srcNodeId, m_context);
+
+    handleAlive(m_context);
     break;
   }
   case LeaderElectionCode::VICTORY: {
     // If P receives a Coordinator message, it treats the sender as the
     // coordinator.
-    setLeaderNodeId(srcNodeId, m_mutex, m_leaderNodeId);
+    handleVictory(srcNodeId, receivedMessage, m_context);
+    break;
+  }
+  case LeaderElectionCode::REQUEST_VOTE: {
+    // a node granting its vote or learning of a new term waits for the outcome
+    // of the election from the beginning of its timeout
+    bool isReset =
+        handleRequestVote(srcNodeId, receivedMessage, m_messenger, m_context);
+
+    if (isReset == true) {
+      this->startElection();
+    }
+    break;
+  }
+  case LeaderElectionCode::VOTE: {
+    handleVote(receivedMessage, m_context);
+    break;
+  }
+  case LeaderElectionCode::PROBE: {
+    // answer the round trip probe of a starting node with its round
+    Message probeAck;
+    m_messenger.setMessage(LeaderElectionCode::PROBE_ACK, probeAck);
+    probeAck.setData(receivedMessage.getData());
+
+    m_messenger.send(srcNodeId, probeAck);
+    break;
+  }
+  case LeaderElectionCode::PROBE_ACK: {
+    handleProbeAck(srcNodeId, receivedMessage, m_context);
+    break;
+  }
+  case LeaderElectionCode::TRANSFER: {
+    // the repl of this node asks for the leadership, the request is forwarded
+    // to the leader which hands its leadership over to the requesting node
+    int leaderNodeId = this->getLeaderNodeId();
+
+    if (srcNodeId != nodeId) {
+      std::thread transferThread = std::thread(handOver,
+                                               std::ref(m_messenger),
+                                               std::ref(m_context),
+                                               m_receiverManager,
+                                               srcNodeId);
+      transferThread.detach();
+    } else if (leaderNodeId != -1 && leaderNodeId != nodeId) {
+      Message transferMessage;
+      m_messenger.setMessage(LeaderElectionCode::TRANSFER, transferMessage);
+
+      m_messenger.send(leaderNodeId, transferMessage);
+    }
+    break;
+  }
+  case LeaderElectionCode::HANDOVER: {
+    PayloadReader reader(receivedMessage.getData());
+
+    int entryCount;
+    int64_t term;
+    reader.read(entryCount);
+    reader.read(term);
+
+    if (reader.getIsValid() == true) {
+      std::thread takeOverThread = std::thread(takeOver,
+                                               std::ref(m_messenger),
+                                               m_receiverManager,
+                                               srcNodeId,
+                                               receivedMessage.getId(),
+                                               entryCount,
+                                               term);
+      takeOverThread.detach();
+    }
+    break;
+  }
+  case LeaderElectionCode::TAKE_OVER: {
+    // the target of a handover caught up with the log of this leader
+    handleTakeOver(srcNodeId, receivedMessage, m_messenger, m_context);
+    break;
+  }
+  case LeaderElectionCode::TAKE_OVER_ACK: {
+    // the leader stepped down, this node takes the leadership over
+    PayloadReader reader(receivedMessage.getData());
+
+    int64_t handoverId;
+    int64_t term;
+    reader.read(handoverId);
+    reader.read(term);
+
+    if (reader.getIsValid() == true) {
+      std::thread takeOverThread = std::thread(completeTakeOver,
+                                               std::ref(m_messenger),
+                                               std::ref(m_context),
+                                               m_receiverManager,
+                                               m_mode,
+                                               handoverId,
+                                               term);
+      takeOverThread.detach();
+    }
     break;
   }
   }
@@ -229,7 +971,12 @@ ElectionManager::stopReceiver() {
 
 int
 ElectionManager::getLeaderNodeId() {
-  std::unique_lock<std::mutex> lock(m_mutex);
+  std::unique_lock<std::mutex> lock(m_context.mutex);
 
-  return m_leaderNodeId;
+  return m_context.leaderNodeId;
+}
+
+bool
+ElectionManager::transferLeadership(const int& dstNodeId) {
+  return handOver(m_messenger, m_context, m_receiverManager, dstNodeId);
 }
@@ -1,19 +1,92 @@
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
 #include <json.hpp>
 
 #include "failure-manager.hh"
 #include "election-manager.hh"
 #include "receiver-manager.hh"
-
-#define TIMEOUT_DURATION 1
-#define LOOP_SLEEP_DURATION 500
-#define RECOVERY_DURATION 3
+#include "transfer-manager.hh"
+#include "log-reader.hh"
+#include "payload.hh"
+
+#define LOOP_SLEEP_DURATION 100
+#define PING_INTERVAL 500
+#define RECOVERY_TIMEOUT 3000
+#define ARRIVAL_WINDOW_SIZE 100
+#define MIN_ARRIVAL_COUNT 10
+#define FIRST_INTERVAL_ESTIMATE 1000000
+#define MIN_INTERVAL_DEVIATION 75000
+#define PROTOCOL_PERIOD 500
+#define PROBE_TIMEOUT 200
+#define INDIRECT_PROBE_COUNT 3
+#define SUSPECT_PERIOD_COUNT 3
+#define MAX_UPDATE_COUNT 8
+#define RETRANSMIT_FACTOR 3
 
 FailureManager::FailureManager(Messenger& messenger,
                                std::shared_ptr<ReceiverManager> receiverManager,
-                               LogFileManager& logFileManager)
+                               LogFileManager& logFileManager,
+                               const int& maxRecoveryCount,
+                               const double& phiThreshold,
+                               const FailureDetection& detection)
     : MessageReceiver(messenger, managedTag, receiverManager),
       m_logFileManager(logFileManager) {
+  m_context.maxRecoveryCount = std::max(maxRecoveryCount, 1);
+  m_context.phiThreshold = phiThreshold;
+  m_context.detection = detection;
+}
+
+void
+addArrival(FailureManager::ArrivalWindow& window, const int64_t& interval) {
+  window.intervals.push_back(interval);
+  window.sum += interval;
+  window.squareSum += interval * interval;
+
+  if (window.intervals.size() > ARRIVAL_WINDOW_SIZE) {
+    int64_t oldest = window.intervals.front();
+    window.intervals.pop_front();
+
+    window.sum -= oldest;
+    window.squareSum -= oldest * oldest;
+  }
+}
+
+void
+resetArrivals(FailureManager::ArrivalWindow& window) {
+  window.intervals.clear();
+  window.sum = 0;
+  window.squareSum = 0;
+}
+
+// returns the suspicion of the node given the time elapsed since its last ping
+// in microseconds, a suspicion of 1 means that the ping would have arrived by
+// now in 90% of the cases, 2 in 99% of the cases and so on
+double
+getPhi(const FailureManager::ArrivalWindow& window, const int64_t& elapsed) {
+  double count = static_cast<double>(window.intervals.size());
+  double mean = FIRST_INTERVAL_ESTIMATE;
+  double variance = mean * mean / 16;
+
+  // a node is not suspected before its pings give an idea of their intervals
+  if (count >= MIN_ARRIVAL_COUNT) {
+    mean = window.sum / count;
+    variance = window.squareSum / count - mean * mean;
+  }
+
+  // a floor on the deviation keeps very regular links from being suspected
+  // over the slightest delay
+  double deviation = std::max(std::sqrt(std::max(variance, 0.0)),
+                              static_cast<double>(MIN_INTERVAL_DEVIATION));
+
+  // the intervals are assumed to follow a normal distribution
+  double laterProbability =
+      0.5 * std::erfc((elapsed - mean) / (deviation * std::sqrt(2.0)));
+
+  return -std::log10(
+      std::max(laterProbability, std::numeric_limits<double>::min()));
 }
 
 void
@@ -30,22 +103,20 @@ indexToId(const int& nodeId, const int& index) {
   return index < nodeId ? index : index + 1;
 }
 
+// the node is marked as failed by the caller under the lock of the context
 void
 handleNodeFailure(int nodeIndex,
                   Messenger& messenger,
-                  std::vector<bool>& isAlive,
                   std::shared_ptr<ReceiverManager>& receiverManager) {
-  isAlive[nodeIndex] = false;
-  messenger.setNodeStatus(nodeIndex, false);
-
   int nodeId = messenger.getRank();
   std::shared_ptr<ElectionManager> electionManager =
       receiverManager->getReceiver<ElectionManager>();
 
   int failedNodeId = indexToId(nodeId, nodeIndex);
 
+  // the election is started as soon as the failure is detected, the election
+  // timeouts cover the nodes that have not detected it yet
   if (electionManager->getLeaderNodeId() == failedNodeId) {
-    std::this_thread::sleep_for(std::chrono::seconds(TIMEOUT_DURATION * 2));
     electionManager->startElection();
   }
 }
@@ -64,45 +135,77 @@ FailureManager::disallowRecovery() {
 void
 handleNodeRecovery(int nodeIndex,
                    Messenger& messenger,
-                   LogFileManager& logFileManager,
                    std::shared_ptr<ReceiverManager>& receiverManager,
                    FailureManager::Context& failureContext) {
+  // ask the recovering node where its log stops matching ours
   Message message;
-  messenger.setMessage(FailureCode::STATE, message);
+  messenger.setMessage(FailureCode::SYNC, message);
+
+  int64_t recoveryId = message.getId();
 
   {
-    std::unique_lock<std::mutex> lock(failureContext.curRecoveryIdMutex);
+    std::unique_lock<std::mutex> lock(failureContext.recoveryMutex);
 
-    failureContext.curRecoveryId = message.getId();
+    failureContext.recoveryIds[nodeIndex] = recoveryId;
   }
 
-  // pause the client manager
+  std::shared_ptr<TransferManager> transferManager =
+      receiverManager->getReceiver<TransferManager>();
+
+  // the followers that are neither failed nor recovering serve the bulk of the
+  // log in place of the leader
+  std::vector<int> sourceNodeIds;
+
   {
-    std::unique_lock<std::mutex> lock(failureContext.clientConnMutex);
+    std::unique_lock<std::mutex> lock(failureContext.mutex);
+    std::unique_lock<std::mutex> recoveryLock(failureContext.recoveryMutex);
+
+    for (int i = 0; i < messenger.getClusterSize() - 1; i++) {
+      if (failureContext.isAlive[i] == true &&
+          failureContext.recoveryIds[i] == -1) {
+        sourceNodeIds.push_back(indexToId(messenger.getRank(), i));
+      }
+    }
+  }
 
-    std::string logContents;
-    logFileManager.read(logContents);
-    nlohmann::json json = {{"state", logContents}};
-    const std::string& jsonString = json.dump();
+  int dstNodeId = indexToId(messenger.getRank(), nodeIndex);
+  messenger.send(dstNodeId, message);
 
-    message.setData(jsonString);
+  // stream the bulk of the log while the client manager keeps running
+  bool isCaughtUp = transferManager->sendState(
+      dstNodeId, recoveryId, false, sourceNodeIds);
 
-    int dstNodeId = indexToId(messenger.getRank(), nodeIndex);
-    messenger.send(dstNodeId, message);
+  if (isCaughtUp == true) {
+    // pause the client manager to send the last entries, the rounds reaching
+    // this point at the same time share the pause
+    std::shared_lock<std::shared_mutex> lock(failureContext.clientConnMutex);
 
-    std::this_thread::sleep_for(std::chrono::seconds(RECOVERY_DURATION));
+    bool isComplete =
+        transferManager->sendState(dstNodeId, recoveryId, true, {});
 
-    {
-      std::unique_lock<std::mutex> lock(failureContext.curRecoveryIdMutex);
+    // the node reports its recovery on the failure tag, the round ends once
+    // that report is handled
+    std::unique_lock<std::mutex> recoveryLock(failureContext.recoveryMutex);
 
-      failureContext.curRecoveryId = -1;
-    }
+    failureContext.recoveryConditional.wait_for(
+        recoveryLock, std::chrono::milliseconds(RECOVERY_TIMEOUT), [&] {
+          return isComplete == false ||
+                 failureContext.updatedIds[nodeIndex] == recoveryId;
+        });
   }
+
+  {
+    std::unique_lock<std::mutex> lock(failureContext.recoveryMutex);
+
+    failureContext.recoveryIds[nodeIndex] = -1;
+    failureContext.recoveryCount--;
+  }
+
+  transferManager->closeStream(dstNodeId);
 }
 
 void
 checkTimeStamps(Messenger& messenger,
-                LogFileManager& logFileManager,
                 std::shared_ptr<ReceiverManager>& receiverManager,
                 FailureManager::Context& failureContext) {
   for (int i = 0; i < messenger.getClusterSize() - 1; i++) {
@@ -111,36 +214,59 @@ checkTimeStamps(Messenger& messenger,
 
       timePoint lastSeen = failureContext.timeStamps[i];
       auto cur = std::chrono::high_resolution_clock::now();
-      int elapsed =
-          std::chrono::duration_cast<std::chrono::seconds>(cur - lastSeen)
+      int64_t elapsed =
+          std::chrono::duration_cast<std::chrono::microseconds>(cur - lastSeen)
               .count();
 
-      if (failureContext.isAlive[i] == true && elapsed > TIMEOUT_DURATION) {
+      // with the swim protocol the failures are confirmed by the gossip
+      bool isSuspected =
+          failureContext.detection == FailureDetection::SWIM
+              ? failureContext.members[indexToId(messenger.getRank(), i)]
+                        .state == MemberState::FAILED
+              : getPhi(failureContext.arrivalWindows[i], elapsed) >
+                    failureContext.phiThreshold;
+
+      if (failureContext.isAlive[i] == true && isSuspected == true) {
         int nodeId = i < messenger.getRank() ? i : i + 1;
 
         std::string str("failure detected: ");
         str.append(std::to_string(nodeId));
         print::printString(messenger.getRank(), str);
 
-        // disable communication to the failed node and trigger and election if
-        // the failed node was the leader
-        std::thread failureThread =
-            std::thread(handleNodeFailure,
-                        i,
-                        std::ref(messenger),
-                        std::ref(failureContext.isAlive),
-                        std::ref(receiverManager));
+        // disable communication to the failed node while holding the lock, so
+        // that the next pass does not handle the same failure again, and
+        // trigger an election if the failed node was the leader
+        failureContext.isAlive[i] = false;
+        messenger.setNodeStatus(i, false);
+
+        std::thread failureThread = std::thread(
+            handleNodeFailure, i, std::ref(messenger), std::ref(receiverManager));
         failureThread.detach();
-      } else if (failureContext.isAlive[i] == false &&
-                 elapsed < TIMEOUT_DURATION) {
+      } else if (failureContext.isAlive[i] == false && isSuspected == false) {
         std::shared_ptr<ElectionManager> electionManager =
             receiverManager->getReceiver<ElectionManager>();
 
-        bool noCurrentRecovery = failureContext.curRecoveryId == -1;
         int leaderNodeId = electionManager->getLeaderNodeId();
         int nodeId = messenger.getRank();
+        bool canRecover;
+
+        {
+          std::unique_lock<std::mutex> lock(failureContext.recoveryMutex);
+
+          canRecover = leaderNodeId == nodeId &&
+                       failureContext.recoveryIds[i] == -1 &&
+                       failureContext.recoveryCount <
+                           failureContext.maxRecoveryCount;
+
+          // reserve the slot of the node until the round gets its id, no
+          // message has the id 0
+          if (canRecover == true) {
+            failureContext.recoveryIds[i] = 0;
+            failureContext.recoveryCount++;
+          }
+        }
 
-        if (noCurrentRecovery == true && leaderNodeId == nodeId) {
+        if (canRecover == true) {
           int nodeId = i < messenger.getRank() ? i : i + 1;
           std::string str("recovery detected: ");
           str.append(std::to_string(nodeId));
@@ -150,7 +276,6 @@ checkTimeStamps(Messenger& messenger,
           std::thread recoveryThread = std::thread(handleNodeRecovery,
                                                    i,
                                                    std::ref(messenger),
-                                                   std::ref(logFileManager),
                                                    std::ref(receiverManager),
                                                    std::ref(failureContext));
           recoveryThread.detach();
@@ -162,13 +287,15 @@ checkTimeStamps(Messenger& messenger,
 
 void
 pingCheck(Messenger& messenger,
-          LogFileManager& logFileManager,
           std::shared_ptr<ReceiverManager>& receiverManager,
           FailureManager::Context& failureContext,
           bool& pingThreadIsUp) {
   std::shared_ptr<ReplManager> replManager =
       receiverManager->getReceiver<ReplManager>();
 
+  timePoint lastPing = std::chrono::high_resolution_clock::now() -
+                       std::chrono::milliseconds(PING_INTERVAL);
+
   bool isUp = true;
   while (isUp == true) {
     replManager->sleep();
@@ -176,13 +303,357 @@ pingCheck(Messenger& messenger,
     std::this_thread::sleep_for(std::chrono::milliseconds(LOOP_SLEEP_DURATION));
 
     // check the timestamps of all nodes
-    checkTimeStamps(messenger,
-                    logFileManager,
-                    receiverManager,
-                    failureContext);
+    checkTimeStamps(messenger, receiverManager, failureContext);
+
+    // broadcast ping message to all nodes. The suspicion is checked more often
+    // than the nodes ping so that a failure is detected soon after the
+    // suspicion crosses the threshold
+    auto cur = std::chrono::high_resolution_clock::now();
+    if (cur - lastPing >= std::chrono::milliseconds(PING_INTERVAL)) {
+      broadcastPing(messenger);
+      lastPing = cur;
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(failureContext.mutex);
+      isUp = pingThreadIsUp;
+    }
+  }
+}
+
+// the caller must hold the lock of the context
+void
+enqueueUpdate(FailureManager::Context& context, const int& nodeId) {
+  const FailureManager::Member& member = context.members[nodeId];
+
+  context.updates[nodeId] = {member.state, member.incarnation, 0};
+}
+
+// the caller must hold the lock of the context
+void
+applyUpdate(const int& nodeId,
+            const MemberState& state,
+            const int64_t& incarnation,
+            const int& selfNodeId,
+            FailureManager::Context& context) {
+  FailureManager::Member& member = context.members[nodeId];
+
+  if (nodeId == selfNodeId) {
+    // a node refutes its suspicion by gossiping a newer incarnation of itself
+    if (state != MemberState::ALIVE && incarnation >= member.incarnation) {
+      member.incarnation = incarnation + 1;
+      enqueueUpdate(context, nodeId);
+    }
+  } else if (incarnation > member.incarnation ||
+             (incarnation == member.incarnation && state > member.state)) {
+    // a newer incarnation overrides any state, a failure overrides a suspicion
+    // which overrides a live member of the same incarnation
+    member.state = state;
+    member.incarnation = incarnation;
+    member.suspectTime = std::chrono::high_resolution_clock::now();
+
+    enqueueUpdate(context, nodeId);
+  }
+}
+
+// the caller must hold the lock of the context
+void
+writeUpdates(const int& dstNodeId,
+             const int& clusterSize,
+             FailureManager::Context& context,
+             PayloadWriter& writer) {
+  // a member which is not deemed alive is told so, so that it can refute it
+  if (context.members[dstNodeId].state != MemberState::ALIVE) {
+    enqueueUpdate(context, dstNodeId);
+  }
+
+  // the updates sent the least often go first
+  std::vector<std::map<int, FailureManager::Update>::iterator> updates;
+  for (auto ite = context.updates.begin(); ite != context.updates.end();
+       ite++) {
+    updates.push_back(ite);
+  }
+
+  std::stable_sort(updates.begin(), updates.end(), [](auto& a, auto& b) {
+    return a->second.sendCount < b->second.sendCount;
+  });
+
+  if (updates.size() > MAX_UPDATE_COUNT) {
+    updates.resize(MAX_UPDATE_COUNT);
+  }
+
+  // every update is sent a number of times growing with the log of the size
+  // of the cluster, after which every node heard of it with high probability
+  int maxSendCount =
+      RETRANSMIT_FACTOR * static_cast<int>(std::ceil(std::log2(clusterSize)));
+
+  writer.write(static_cast<int>(updates.size()));
+
+  for (auto& ite : updates) {
+    writer.write(ite->first);
+    writer.write(static_cast<int>(ite->second.state));
+    writer.write(ite->second.incarnation);
+
+    ite->second.sendCount++;
+    if (ite->second.sendCount >= maxSendCount) {
+      context.updates.erase(ite);
+    }
+  }
+}
+
+// returns whether the payload was valid
+bool
+readUpdates(const int& selfNodeId,
+            const int& clusterSize,
+            FailureManager::Context& context,
+            PayloadReader& reader) {
+  int updateCount;
+  reader.read(updateCount);
+
+  std::unique_lock<std::mutex> lock(context.mutex);
+
+  for (int i = 0; i < updateCount && reader.getIsValid() == true; i++) {
+    int nodeId;
+    int state;
+    int64_t incarnation;
+    reader.read(nodeId);
+    reader.read(state);
+    reader.read(incarnation);
+
+    bool isValid = reader.getIsValid() == true && 0 <= nodeId &&
+                   nodeId < clusterSize &&
+                   static_cast<int>(MemberState::ALIVE) <= state &&
+                   state <= static_cast<int>(MemberState::FAILED);
+
+    if (isValid == true) {
+      applyUpdate(nodeId,
+                  static_cast<MemberState>(state),
+                  incarnation,
+                  selfNodeId,
+                  context);
+    }
+  }
+
+  return reader.getIsValid();
+}
+
+// probes, probe requests and acknowledgements carry a sequence number, a node
+// id and the membership updates
+void
+sendProbeMessage(Messenger& messenger,
+                 FailureManager::Context& context,
+                 const FailureCode& code,
+                 const int& dstNodeId,
+                 const int64_t& probeSeq,
+                 const int& nodeId) {
+  PayloadWriter writer;
+  writer.write(probeSeq);
+  writer.write(nodeId);
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    writeUpdates(dstNodeId, messenger.getClusterSize(), context, writer);
+  }
+
+  std::string data;
+  writer.moveData(data);
+
+  Message message;
+  messenger.setMessage(code, message);
+  message.setData(std::move(data));
+
+  messenger.send(dstNodeId, message);
+}
+
+// returns whether the payload was valid
+bool
+readProbeMessage(const Message& receivedMessage,
+                 const Messenger& messenger,
+                 FailureManager::Context& context,
+                 int64_t& probeSeq,
+                 int& nodeId) {
+  PayloadReader reader(receivedMessage.getData());
+  reader.read(probeSeq);
+  reader.read(nodeId);
+
+  return readUpdates(
+             messenger.getRank(), messenger.getClusterSize(), context, reader) ==
+             true &&
+         0 <= nodeId && nodeId < messenger.getClusterSize();
+}
+
+// the members are probed in turn from a list shuffled on every pass, so that
+// every member is probed within two passes
+int
+getProbeTarget(const Messenger& messenger,
+               FailureManager::Context& context,
+               std::vector<int>& targets,
+               std::size_t& targetIndex,
+               std::mt19937& generator) {
+  for (int pass = 0; pass < 2; pass++) {
+    for (; targetIndex < targets.size(); targetIndex++) {
+      int nodeId = targets[targetIndex];
+
+      std::unique_lock<std::mutex> lock(context.mutex);
+
+      if (context.members[nodeId].state != MemberState::FAILED) {
+        targetIndex++;
+        return nodeId;
+      }
+    }
+
+    targets.clear();
+    for (int i = 0; i < messenger.getClusterSize(); i++) {
+      if (i != messenger.getRank()) {
+        targets.push_back(i);
+      }
+    }
+
+    std::shuffle(targets.begin(), targets.end(), generator);
+    targetIndex = 0;
+  }
+
+  return -1;
+}
+
+void
+requestProbes(Messenger& messenger,
+              FailureManager::Context& context,
+              const int& targetNodeId,
+              const int64_t& probeSeq,
+              std::mt19937& generator) {
+  std::vector<int> helperNodeIds;
+
+  {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    for (int i = 0; i < messenger.getClusterSize(); i++) {
+      if (i != messenger.getRank() && i != targetNodeId &&
+          context.members[i].state != MemberState::FAILED) {
+        helperNodeIds.push_back(i);
+      }
+    }
+  }
+
+  std::shuffle(helperNodeIds.begin(), helperNodeIds.end(), generator);
+
+  if (helperNodeIds.size() > INDIRECT_PROBE_COUNT) {
+    helperNodeIds.resize(INDIRECT_PROBE_COUNT);
+  }
+
+  for (const int& helperNodeId : helperNodeIds) {
+    sendProbeMessage(messenger,
+                     context,
+                     FailureCode::PROBE_REQ,
+                     helperNodeId,
+                     probeSeq,
+                     targetNodeId);
+  }
+}
+
+void
+expireSuspicions(FailureManager::Context& context) {
+  auto cur = std::chrono::high_resolution_clock::now();
+  auto timeout = std::chrono::milliseconds(PROTOCOL_PERIOD) *
+                 SUSPECT_PERIOD_COUNT;
+
+  std::unique_lock<std::mutex> lock(context.mutex);
 
-    // broadcast ping message to all nodes
-    broadcastPing(messenger);
+  for (std::size_t i = 0; i < context.members.size(); i++) {
+    FailureManager::Member& member = context.members[i];
+
+    if (member.state == MemberState::SUSPECT &&
+        cur - member.suspectTime >= timeout) {
+      member.state = MemberState::FAILED;
+      enqueueUpdate(context, i);
+    }
+  }
+}
+
+void
+swimCheck(Messenger& messenger,
+          std::shared_ptr<ReceiverManager>& receiverManager,
+          FailureManager::Context& failureContext,
+          bool& pingThreadIsUp) {
+  std::shared_ptr<ReplManager> replManager =
+      receiverManager->getReceiver<ReplManager>();
+
+  std::mt19937 generator(std::random_device{}());
+  std::vector<int> targets;
+  std::size_t targetIndex = 0;
+
+  int targetNodeId = -1;
+  int64_t probeSeq = 0;
+  bool isIndirect = false;
+  timePoint periodStart = std::chrono::high_resolution_clock::now() -
+                          std::chrono::milliseconds(PROTOCOL_PERIOD);
+
+  bool isUp = true;
+  while (isUp == true) {
+    replManager->sleep();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(LOOP_SLEEP_DURATION));
+
+    auto cur = std::chrono::high_resolution_clock::now();
+    bool isAcked;
+
+    {
+      std::unique_lock<std::mutex> lock(failureContext.mutex);
+      isAcked = failureContext.isAcked;
+    }
+
+    // the target did not answer in time, other members probe it on behalf of
+    // this node
+    if (targetNodeId != -1 && isAcked == false && isIndirect == false &&
+        cur - periodStart >= std::chrono::milliseconds(PROBE_TIMEOUT)) {
+      requestProbes(
+          messenger, failureContext, targetNodeId, probeSeq, generator);
+      isIndirect = true;
+    }
+
+    bool isPeriodOver =
+        cur - periodStart >= std::chrono::milliseconds(PROTOCOL_PERIOD);
+
+    // no member got an answer from the target by the end of the period
+    if (targetNodeId != -1 && isAcked == false && isPeriodOver == true) {
+      std::unique_lock<std::mutex> lock(failureContext.mutex);
+
+      FailureManager::Member& member = failureContext.members[targetNodeId];
+      if (member.state == MemberState::ALIVE) {
+        member.state = MemberState::SUSPECT;
+        member.suspectTime = cur;
+        enqueueUpdate(failureContext, targetNodeId);
+      }
+    }
+
+    expireSuspicions(failureContext);
+
+    checkTimeStamps(messenger, receiverManager, failureContext);
+
+    // probe the next member once per protocol period
+    if (isPeriodOver == true) {
+      targetNodeId = getProbeTarget(
+          messenger, failureContext, targets, targetIndex, generator);
+      isIndirect = false;
+      periodStart = cur;
+
+      {
+        std::unique_lock<std::mutex> lock(failureContext.mutex);
+
+        probeSeq = ++failureContext.probeSeq;
+        failureContext.isAcked = false;
+      }
+
+      if (targetNodeId != -1) {
+        sendProbeMessage(messenger,
+                         failureContext,
+                         FailureCode::PROBE,
+                         targetNodeId,
+                         probeSeq,
+                         messenger.getRank());
+      }
+    }
 
     {
       std::unique_lock<std::mutex> lock(failureContext.mutex);
@@ -197,15 +668,22 @@ FailureManager::init() {
 
   m_context.timeStamps.resize(n);
   m_context.isAlive.resize(n);
+  m_context.arrivalWindows.resize(n);
+  m_context.recoveryIds.assign(n, -1);
+  m_context.updatedIds.assign(n, -1);
 
   for (int i = 0; i < n; i++) {
     m_context.timeStamps[i] = std::chrono::high_resolution_clock::now();
     m_context.isAlive[i] = true;
+    resetArrivals(m_context.arrivalWindows[i]);
   }
 
-  m_pingThread = std::thread(pingCheck,
+  m_context.members.assign(m_messenger.getClusterSize(),
+                           FailureManager::Member());
+
+  bool isSwim = m_context.detection == FailureDetection::SWIM;
+  m_pingThread = std::thread(isSwim == true ? swimCheck : pingCheck,
                              std::ref(m_messenger),
-                             std::ref(m_logFileManager),
                              std::ref(m_receiverManager),
                              std::ref(m_context),
                              std::ref(m_pingThreadIsUp));
@@ -235,31 +713,29 @@ enableComm(const int& recoveredNodeId,
            std::vector<bool>& isAlive) {
   int nodeIndex = idToIndex(messenger.getRank(), recoveredNodeId);
 
-  messenger.setNodeStatus(nodeIndex, true);
+  // the status of the node changes along with its liveness, under the lock
+  // held by the failure detection
+  std::unique_lock<std::mutex> lock(mutex);
 
-  {
-    std::unique_lock<std::mutex> lock(mutex);
-    isAlive[nodeIndex] = true;
-  }
+  isAlive[nodeIndex] = true;
+  messenger.setNodeStatus(nodeIndex, true);
 }
 
 void
 handleStateUpdate(const int& srcNodeId,
                   const Message& receivedMessage,
                   Messenger& messenger,
-                  std::mutex& mutex,
-                  std::mutex& curRecoveryIdMutex,
-                  int& curRecoveryId,
                   std::shared_ptr<ReceiverManager>& receiverManager,
-                  std::vector<bool>& isAlive) {
+                  FailureManager::Context& failureContext) {
   const std::string& messageData = receivedMessage.getData();
   nlohmann::json json = nlohmann::json::parse(messageData);
-  int recoveryId = json.at("recoveryId");
+  int64_t recoveryId = json.at("recoveryId");
+  int nodeIndex = idToIndex(messenger.getRank(), srcNodeId);
   bool correctRecoveryId;
 
   {
-    std::unique_lock<std::mutex> lock(curRecoveryIdMutex);
-    correctRecoveryId = curRecoveryId == recoveryId;
+    std::unique_lock<std::mutex> lock(failureContext.recoveryMutex);
+    correctRecoveryId = failureContext.recoveryIds[nodeIndex] == recoveryId;
   }
 
   std::shared_ptr<ElectionManager> electionManager =
@@ -270,7 +746,16 @@ handleStateUpdate(const int& srcNodeId,
   if (correctRecoveryId == true && amLeader == true) {
     broadcastRecovered(messenger, srcNodeId);
 
-    enableComm(srcNodeId, messenger, mutex, isAlive);
+    enableComm(
+        srcNodeId, messenger, failureContext.mutex, failureContext.isAlive);
+  }
+
+  // end the recovery round waiting for this update
+  if (correctRecoveryId == true) {
+    std::unique_lock<std::mutex> lock(failureContext.recoveryMutex);
+
+    failureContext.updatedIds[nodeIndex] = recoveryId;
+    failureContext.recoveryConditional.notify_all();
   }
 
   Message victory;
@@ -284,6 +769,7 @@ handleRecovered(const Message& receivedMessage,
                 Messenger& messenger,
                 std::mutex& mutex,
                 std::vector<timePoint>& timeStamps,
+                std::vector<FailureManager::ArrivalWindow>& arrivalWindows,
                 std::vector<bool>& isAlive) {
   const std::string& messageData = receivedMessage.getData();
   nlohmann::json json = nlohmann::json::parse(messageData);
@@ -292,8 +778,12 @@ handleRecovered(const Message& receivedMessage,
   int nodeIndex = idToIndex(nodeId, recoveredNodeId);
 
   if (nodeId == recoveredNodeId) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // the pings received while this node was down say nothing of the links
     for (int i = 0; i < messenger.getClusterSize() - 1; i++) {
       timeStamps[i] = std::chrono::high_resolution_clock::now();
+      resetArrivals(arrivalWindows[i]);
     }
   } else {
     enableComm(recoveredNodeId, messenger, mutex, isAlive);
@@ -301,36 +791,197 @@ handleRecovered(const Message& receivedMessage,
 }
 
 void
-handleState(const int& srcNodeId,
-            const Message& receivedMessage,
-            Messenger& messenger,
-            LogFileManager& logFileManager) {
-  const std::string& messageData = receivedMessage.getData();
-  nlohmann::json messageDataJson = nlohmann::json::parse(messageData);
-  const std::string& logContents = messageDataJson.at("state");
+handleSync(const int& srcNodeId,
+           const Message& receivedMessage,
+           Messenger& messenger,
+           LogFileManager& logFileManager) {
+  int entryCount = logFileManager.getEntryCount();
+
+  // report the checksums of exponentially spaced entries from the end of the
+  // log so that the leader finds the common prefix in a single round trip
+  std::vector<int> indexes;
+  for (int step = 1; step <= entryCount; step *= 2) {
+    indexes.push_back(entryCount - step);
+  }
 
-  logFileManager.replace(logContents);
+  if (entryCount > 0 && indexes.back() != 0) {
+    indexes.push_back(0);
+  }
 
-  int id = receivedMessage.getId();
-  nlohmann::json json = {{"recoveryId", id}};
-  const std::string& jsonString = json.dump();
+  PayloadWriter writer;
+  writer.write(receivedMessage.getId());
+  writer.write(entryCount);
+  writer.write(static_cast<int>(indexes.size()));
+
+  for (const int& index : indexes) {
+    uint32_t checksum = 0;
+    logFileManager.getChecksum(index, checksum);
+
+    writer.write(index);
+    writer.write(static_cast<int>(checksum));
+  }
+
+  std::string data;
+  writer.moveData(data);
 
   Message message;
-  messenger.setMessage(FailureCode::STATE_UPDATED, jsonString, message);
+  messenger.setMessage(FailureCode::SYNC_INFO, message);
+  message.setData(std::move(data));
 
   messenger.send(srcNodeId, message);
 }
 
+void
+handleSyncInfo(const int& srcNodeId,
+               const Message& receivedMessage,
+               Messenger& messenger,
+               LogFileManager& logFileManager,
+               std::shared_ptr<ReceiverManager>& receiverManager,
+               std::mutex& recoveryMutex,
+               std::vector<int64_t>& recoveryIds) {
+  PayloadReader reader(receivedMessage.getData());
+
+  int64_t recoveryId;
+  int entryCount;
+  int checksumCount;
+  reader.read(recoveryId);
+  reader.read(entryCount);
+  reader.read(checksumCount);
+
+  int nodeIndex = idToIndex(messenger.getRank(), srcNodeId);
+  bool correctRecoveryId;
+
+  {
+    std::unique_lock<std::mutex> lock(recoveryMutex);
+    correctRecoveryId = recoveryIds[nodeIndex] == recoveryId;
+  }
+
+  if (reader.getIsValid() == false || correctRecoveryId == false) {
+    return;
+  }
+
+  LogReader logReader;
+  logFileManager.openReader(logReader);
+
+  int leaderEntryCount = logReader.getEntryCount();
+
+  // the indexes are sent in decreasing order, the first matching checksum
+  // marks the end of the common prefix
+  int firstIndex = 0;
+  bool isMatched = false;
+  for (int i = 0; i < checksumCount && isMatched == false; i++) {
+    int index;
+    int checksum;
+    reader.read(index);
+    reader.read(checksum);
+
+    uint32_t leaderChecksum;
+    isMatched = reader.getIsValid() == true && index < leaderEntryCount &&
+                logReader.getChecksum(index, leaderChecksum) == true &&
+                leaderChecksum == static_cast<uint32_t>(checksum);
+
+    if (isMatched == true) {
+      firstIndex = index + 1;
+    }
+  }
+
+  // the missing entries are streamed from the common prefix on
+  std::shared_ptr<TransferManager> transferManager =
+      receiverManager->getReceiver<TransferManager>();
+  transferManager->openStream(srcNodeId, recoveryId, firstIndex);
+}
+
 void
 handlePing(const int& srcNodeId,
            Messenger& messenger,
-           std::mutex& mutex,
-           std::vector<timePoint>& timeStamps) {
+           FailureManager::Context& failureContext) {
   int i = idToIndex(messenger.getRank(), srcNodeId);
 
   {
-    std::unique_lock<std::mutex> lock(mutex);
-    timeStamps[i] = std::chrono::high_resolution_clock::now();
+    std::unique_lock<std::mutex> lock(failureContext.mutex);
+
+    auto cur = std::chrono::high_resolution_clock::now();
+
+    // the silence of a failed node is not an interval between its pings
+    if (failureContext.isAlive[i] == true) {
+      int64_t interval = std::chrono::duration_cast<std::chrono::microseconds>(
+                             cur - failureContext.timeStamps[i])
+                             .count();
+      addArrival(failureContext.arrivalWindows[i], interval);
+    }
+
+    failureContext.timeStamps[i] = cur;
+  }
+}
+
+void
+handleProbe(const int& srcNodeId,
+            const Message& receivedMessage,
+            Messenger& messenger,
+            FailureManager::Context& context) {
+  int64_t probeSeq;
+  int originNodeId;
+
+  if (readProbeMessage(
+          receivedMessage, messenger, context, probeSeq, originNodeId) ==
+      true) {
+    sendProbeMessage(messenger,
+                     context,
+                     FailureCode::ACK,
+                     srcNodeId,
+                     probeSeq,
+                     originNodeId);
+  }
+}
+
+void
+handleProbeRequest(const int& srcNodeId,
+                   const Message& receivedMessage,
+                   Messenger& messenger,
+                   FailureManager::Context& context) {
+  int64_t probeSeq;
+  int targetNodeId;
+
+  // the target answers this node, which relays the answer to the requester
+  if (readProbeMessage(
+          receivedMessage, messenger, context, probeSeq, targetNodeId) ==
+      true) {
+    sendProbeMessage(messenger,
+                     context,
+                     FailureCode::PROBE,
+                     targetNodeId,
+                     probeSeq,
+                     srcNodeId);
+  }
+}
+
+void
+handleAck(const Message& receivedMessage,
+          Messenger& messenger,
+          FailureManager::Context& context) {
+  int64_t probeSeq;
+  int originNodeId;
+
+  if (readProbeMessage(
+          receivedMessage, messenger, context, probeSeq, originNodeId) ==
+      false) {
+    return;
+  }
+
+  if (originNodeId != messenger.getRank()) {
+    sendProbeMessage(messenger,
+                     context,
+                     FailureCode::ACK,
+                     originNodeId,
+                     probeSeq,
+                     originNodeId);
+  } else {
+    std::unique_lock<std::mutex> lock(context.mutex);
+
+    // late answers to the probes of previous periods are ignored
+    if (probeSeq == context.probeSeq) {
+      context.isAcked = true;
+    }
   }
 }
 
@@ -342,12 +993,23 @@ FailureManager::handleMessage(const int& srcNodeId,
   FailureCode code = receivedMessage.getCode<FailureCode>();
   switch (code) {
   case FailureCode::PING: {
-    handlePing(srcNodeId, m_messenger, m_context.mutex, m_context.timeStamps);
+    handlePing(srcNodeId, m_messenger, m_context);
+    break;
+  }
+  case FailureCode::SYNC: {
+    // send back the checksums of some of the entries of the log
+    handleSync(srcNodeId, receivedMessage, m_messenger, m_logFileManager);
     break;
   }
-  case FailureCode::STATE: {
-    // overwrite the log with the contents of this message
-    handleState(srcNodeId, receivedMessage, m_messenger, m_logFileManager);
+  case FailureCode::SYNC_INFO: {
+    // stream the entries the recovering node is missing
+    handleSyncInfo(srcNodeId,
+                   receivedMessage,
+                   m_messenger,
+                   m_logFileManager,
+                   m_receiverManager,
+                   m_context.recoveryMutex,
+                   m_context.recoveryIds);
     break;
   }
   case FailureCode::STATE_UPDATED: {
@@ -356,11 +1018,22 @@ FailureManager::handleMessage(const int& srcNodeId,
     handleStateUpdate(srcNodeId,
                       receivedMessage,
                       m_messenger,
-                      m_context.mutex,
-                      m_context.curRecoveryIdMutex,
-                      m_context.curRecoveryId,
                       m_receiverManager,
-                      m_context.isAlive);
+                      m_context);
+    break;
+  }
+  case FailureCode::PROBE: {
+    // answer the probe of a member, directly or through a relaying member
+    handleProbe(srcNodeId, receivedMessage, m_messenger, m_context);
+    break;
+  }
+  case FailureCode::PROBE_REQ: {
+    // probe a member on behalf of the requesting member
+    handleProbeRequest(srcNodeId, receivedMessage, m_messenger, m_context);
+    break;
+  }
+  case FailureCode::ACK: {
+    handleAck(receivedMessage, m_messenger, m_context);
     break;
   }
   case FailureCode::RECOVERED: {
@@ -370,6 +1043,7 @@ FailureManager::handleMessage(const int& srcNodeId,
                     m_messenger,
                     m_context.mutex,
                     m_context.timeStamps,
+                    m_context.arrivalWindows,
                     m_context.isAlive);
     break;
   }
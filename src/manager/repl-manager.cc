@@ -55,6 +55,15 @@ ReplManager::handleMessage(const int& srcNodeId,
     m_blockConditional.notify_all();
     break;
   }
+  case ReplCode::TRANSFER_LEADER: {
+    // the node asks the leader for the leadership through its own election
+    // receiver
+    Message transferMessage;
+    m_messenger.setMessage(LeaderElectionCode::TRANSFER, transferMessage);
+
+    m_messenger.send(m_messenger.getRank(), transferMessage);
+    break;
+  }
   }
 }
 
@@ -139,6 +148,7 @@ ReplManager::startReceiver() {
   m_receiverManager->stopReceiver(MessageTag::LEADER_ELECTION);
   m_receiverManager->stopReceiver(MessageTag::CONSENSUS);
   m_receiverManager->stopReceiver(MessageTag::FAILURE_DETECTION);
+  m_receiverManager->stopReceiver(MessageTag::STATE_TRANSFER);
 }
 
 void
@@ -159,5 +169,9 @@ ReplManager::sleep() {
         std::chrono::milliseconds(MEDIUM_SPEED_DURATION));
     break;
   }
+  default: {
+    // SPEED_HIGH adds no delay, the other codes never set the speed
+    break;
+  }
   }
 }
@@ -0,0 +1,504 @@
+#include <chrono>
+#include <algorithm>
+#include <json.hpp>
+
+#include "transfer-manager.hh"
+#include "receiver-manager.hh"
+#include "payload.hh"
+
+#define TRANSFER_CHUNK_SIZE 262144
+#define TRANSFER_CHUNK_MAX_ENTRIES 4096
+#define TRANSFER_WINDOW_SIZE 8
+#define TRANSFER_OPEN_TIMEOUT 3000
+#define TRANSFER_ACK_TIMEOUT 1000
+#define TRANSFER_MAX_RETRIES 3
+#define TRANSFER_CATCH_UP_COUNT 256
+
+TransferManager::TransferManager(
+    Messenger& messenger,
+    std::shared_ptr<ReceiverManager> receiverManager,
+    LogFileManager& logFileManager)
+    : MessageReceiver(messenger, managedTag, receiverManager),
+      m_logFileManager(logFileManager) {
+}
+
+void
+TransferManager::openStream(const int& dstNodeId,
+                            const int64_t& recoveryId,
+                            const int& firstIndex) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  Stream& stream = m_streams[dstNodeId];
+  stream = Stream();
+  stream.recoveryId = recoveryId;
+  stream.baseIndex = firstIndex;
+  stream.sentCount = firstIndex;
+  stream.ackedCount = firstIndex;
+
+  m_conditional.notify_all();
+}
+
+void
+TransferManager::closeStream(const int& dstNodeId) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  m_streams.erase(dstNodeId);
+}
+
+// gets the entries of the chunk starting at the given log index, a chunk holds
+// at least one entry if any is left
+void
+getChunk(const LogReader& logReader,
+         const int& firstIndex,
+         const int& entryCount,
+         std::vector<std::string_view>& entries) {
+  logReader.getEntries(
+      firstIndex,
+      std::min(entryCount - firstIndex, TRANSFER_CHUNK_MAX_ENTRIES),
+      entries);
+
+  std::size_t size = 0;
+  std::size_t count = 0;
+  while (count < entries.size() &&
+         (count == 0 || size + entries[count].size() <= TRANSFER_CHUNK_SIZE)) {
+    size += entries[count].size();
+    count++;
+  }
+
+  entries.resize(count);
+}
+
+// the sizes of the entries are part of the checksum so that entries split at
+// other boundaries do not match
+uint32_t
+getChunkChecksum(const std::vector<std::string_view>& entries) {
+  uint32_t checksum = 0;
+
+  for (const std::string_view& entry : entries) {
+    std::string size;
+    codec::writeUint32(static_cast<uint32_t>(entry.size()), size);
+
+    checksum = codec::crc32(size.data(), size.size(), checksum);
+    checksum = codec::crc32(entry.data(), entry.size(), checksum);
+  }
+
+  return checksum;
+}
+
+void
+sendChunk(Messenger& messenger,
+          const int& dstNodeId,
+          const int64_t& recoveryId,
+          const int& baseIndex,
+          const int& firstIndex,
+          const bool& isLast,
+          const int& ackNodeId,
+          const uint32_t& checksum,
+          const std::vector<std::string_view>& entries) {
+  PayloadWriter writer;
+  writer.write(recoveryId);
+  writer.write(baseIndex);
+  writer.write(firstIndex);
+  writer.write(static_cast<int>(isLast));
+  writer.write(ackNodeId);
+  writer.write(static_cast<int>(checksum));
+  writer.write(entries);
+
+  std::string chunk;
+  writer.moveData(chunk);
+
+  Message message;
+  messenger.setMessage(TransferCode::CHUNK, message);
+  message.setData(std::move(chunk));
+
+  messenger.send(dstNodeId, message);
+}
+
+void
+sendForward(Messenger& messenger,
+            const int& sourceNodeId,
+            const int& dstNodeId,
+            const int64_t& recoveryId,
+            const int& baseIndex,
+            const int& firstIndex,
+            const int& count,
+            const uint32_t& checksum) {
+  PayloadWriter writer;
+  writer.write(recoveryId);
+  writer.write(dstNodeId);
+  writer.write(baseIndex);
+  writer.write(firstIndex);
+  writer.write(count);
+  writer.write(static_cast<int>(checksum));
+
+  std::string data;
+  writer.moveData(data);
+
+  Message message;
+  messenger.setMessage(TransferCode::FORWARD, message);
+  message.setData(std::move(data));
+
+  messenger.send(sourceNodeId, message);
+}
+
+bool
+TransferManager::sendState(const int& dstNodeId,
+                           const int64_t& recoveryId,
+                           const bool& isLast,
+                           const std::vector<int>& sourceNodeIds) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  // the stream is opened once the recovering node answered the sync
+  bool isOpen = m_conditional.wait_for(
+      lock, std::chrono::milliseconds(TRANSFER_OPEN_TIMEOUT), [&] {
+        auto streamIte = m_streams.find(dstNodeId);
+        return streamIte != m_streams.end() &&
+               streamIte->second.recoveryId == recoveryId;
+      });
+
+  int retryCount = 0;
+  bool isReadable = true;
+  bool isDone = false;
+  while (isOpen == true && isReadable == true && isDone == false &&
+         retryCount <= TRANSFER_MAX_RETRIES) {
+    lock.unlock();
+
+    // map the log as it is now, the entries appended later are sent by the
+    // next pass
+    LogReader logReader;
+    m_logFileManager.openReader(logReader);
+    int entryCount = logReader.getEntryCount();
+
+    lock.lock();
+
+    Stream& stream = m_streams[dstNodeId];
+    int ackedCount = stream.ackedCount;
+    int pendingCount = entryCount - ackedCount;
+
+    bool hasCredit = true;
+    bool lastIsSent = false;
+    while (hasCredit == true && isReadable == true &&
+           (stream.sentCount < entryCount ||
+            (isLast == true && lastIsSent == false))) {
+      hasCredit = m_conditional.wait_for(
+          lock, std::chrono::milliseconds(TRANSFER_ACK_TIMEOUT), [&] {
+            return stream.inFlightCount < TRANSFER_WINDOW_SIZE;
+          });
+
+      if (hasCredit == true) {
+        int firstIndex = stream.sentCount;
+
+        std::vector<std::string_view> entries;
+        getChunk(logReader, firstIndex, entryCount, entries);
+
+        // a corrupted entry cannot be sent
+        isReadable = entries.empty() == false || firstIndex == entryCount;
+
+        lastIsSent = isLast == true && firstIndex + static_cast<int>(
+                                           entries.size()) == entryCount;
+
+        int endIndex = firstIndex + entries.size();
+        uint32_t checksum = getChunkChecksum(entries);
+
+        // the latest entries are sent by the leader, the followers may not
+        // have them yet
+        bool isForwarded = stream.isForwarding == true &&
+                           sourceNodeIds.empty() == false &&
+                           endIndex <= entryCount - TRANSFER_CATCH_UP_COUNT;
+
+        int sourceNodeId = isForwarded == true
+                               ? sourceNodeIds[stream.forwardCount %
+                                               sourceNodeIds.size()]
+                               : m_messenger.getRank();
+
+        stream.sentCount = endIndex;
+        stream.inFlightCount++;
+        stream.forwardCount += isForwarded == true ? 1 : 0;
+        int baseIndex = stream.baseIndex;
+
+        lock.unlock();
+
+        if (isForwarded == true) {
+          sendForward(m_messenger,
+                      sourceNodeId,
+                      dstNodeId,
+                      recoveryId,
+                      baseIndex,
+                      firstIndex,
+                      entries.size(),
+                      checksum);
+        } else {
+          sendChunk(m_messenger,
+                    dstNodeId,
+                    recoveryId,
+                    baseIndex,
+                    firstIndex,
+                    lastIsSent,
+                    sourceNodeId,
+                    checksum,
+                    entries);
+        }
+
+        lock.lock();
+      }
+    }
+
+    bool isAcked =
+        hasCredit == true && isReadable == true &&
+        m_conditional.wait_for(
+            lock, std::chrono::milliseconds(TRANSFER_ACK_TIMEOUT), [&] {
+              return stream.ackedCount >= entryCount &&
+                     (isLast == false || stream.isComplete == true);
+            });
+
+    if (isAcked == true) {
+      // the bulk of the log is sent as long as it grows faster than a few
+      // chunks per pass
+      isDone = isLast == true || pendingCount <= TRANSFER_CATCH_UP_COUNT;
+      retryCount = 0;
+    } else {
+      // resend from the last acknowledged entry, a follower may have failed
+      // to send its chunk so the leader sends the rest of the log itself
+      retryCount = stream.ackedCount > ackedCount ? 0 : retryCount + 1;
+      stream.isForwarding = false;
+      stream.sentCount = stream.ackedCount;
+      stream.inFlightCount = 0;
+    }
+  }
+
+  return isDone;
+}
+
+// appends the entries of the chunk following the log, the others were received
+// before the chunk was resent
+void
+applyChunk(LogFileManager& logFileManager,
+           const int& firstIndex,
+           const std::vector<std::string_view>& entries,
+           int& entryCount) {
+  int endIndex = firstIndex + entries.size();
+
+  if (endIndex > entryCount) {
+    std::vector<std::string_view> newEntries(
+        entries.begin() + (entryCount - firstIndex), entries.end());
+
+    logFileManager.append(newEntries);
+
+    entryCount = endIndex;
+  }
+}
+
+void
+handleChunk(const Message& receivedMessage,
+            Messenger& messenger,
+            LogFileManager& logFileManager,
+            int64_t& appliedRecoveryId,
+            std::map<int, TransferManager::Chunk>& pendingChunks) {
+  PayloadReader reader(receivedMessage.getData());
+
+  int64_t recoveryId;
+  int baseIndex;
+  int firstIndex;
+  int isLast;
+  int ackNodeId;
+  int checksum;
+  std::vector<std::string_view> entries;
+  reader.read(recoveryId);
+  reader.read(baseIndex);
+  reader.read(firstIndex);
+  reader.read(isLast);
+  reader.read(ackNodeId);
+  reader.read(checksum);
+  reader.read(entries);
+
+  if (reader.getIsValid() == false) {
+    return;
+  }
+
+  int entryCount = logFileManager.getEntryCount();
+
+  // the first chunk of a recovery round drops the divergent tail of the log,
+  // whichever part of the log it holds
+  if (recoveryId != appliedRecoveryId && baseIndex <= entryCount) {
+    logFileManager.truncate(baseIndex);
+    pendingChunks.clear();
+
+    entryCount = baseIndex;
+    appliedRecoveryId = recoveryId;
+  }
+
+  // the checksum given by the leader rules out the entries of a follower
+  // whose log differs from the one of the leader
+  bool isIntact = recoveryId == appliedRecoveryId &&
+                  getChunkChecksum(entries) == static_cast<uint32_t>(checksum);
+
+  int chunkCount = 1;
+  bool isComplete = false;
+
+  if (isIntact == true && firstIndex > entryCount) {
+    // the chunk overtook the ones preceding it, it is acknowledged once
+    // applied
+    TransferManager::Chunk& chunk = pendingChunks[firstIndex];
+    chunk.ackNodeId = ackNodeId;
+    chunk.isLast = isLast == 1;
+    chunk.entries.assign(entries.begin(), entries.end());
+
+    chunkCount = 0;
+  } else if (isIntact == true) {
+    applyChunk(logFileManager, firstIndex, entries, entryCount);
+    isComplete = isLast == 1;
+
+    // apply the chunks that were waiting for this one
+    auto chunkIte = pendingChunks.begin();
+    while (chunkIte != pendingChunks.end() && chunkIte->first <= entryCount) {
+      const TransferManager::Chunk& chunk = chunkIte->second;
+      std::vector<std::string_view> chunkEntries(chunk.entries.begin(),
+                                                 chunk.entries.end());
+
+      applyChunk(logFileManager, chunkIte->first, chunkEntries, entryCount);
+      isComplete = isComplete == true || chunk.isLast == true;
+      chunkCount++;
+
+      chunkIte = pendingChunks.erase(chunkIte);
+    }
+
+    logFileManager.commit();
+  }
+
+  if (isComplete == true) {
+    nlohmann::json json = {{"recoveryId", recoveryId}};
+    const std::string& jsonString = json.dump();
+
+    Message message;
+    messenger.setMessage(FailureCode::STATE_UPDATED, jsonString, message);
+
+    messenger.send(ackNodeId, message);
+  }
+
+  if (chunkCount > 0) {
+    PayloadWriter writer;
+    writer.write(recoveryId);
+    writer.write(entryCount);
+    writer.write(static_cast<int>(isComplete));
+    writer.write(chunkCount);
+
+    std::string ack;
+    writer.moveData(ack);
+
+    Message message;
+    messenger.setMessage(TransferCode::ACK, message);
+    message.setData(std::move(ack));
+
+    messenger.send(ackNodeId, message);
+  }
+}
+
+// sends a chunk of the log of this node in place of the leader, provided the
+// entries match the ones of the leader
+void
+handleForward(const int& srcNodeId,
+              const Message& receivedMessage,
+              Messenger& messenger,
+              LogFileManager& logFileManager) {
+  PayloadReader reader(receivedMessage.getData());
+
+  int64_t recoveryId;
+  int dstNodeId;
+  int baseIndex;
+  int firstIndex;
+  int count;
+  int checksum;
+  reader.read(recoveryId);
+  reader.read(dstNodeId);
+  reader.read(baseIndex);
+  reader.read(firstIndex);
+  reader.read(count);
+  reader.read(checksum);
+
+  LogReader logReader;
+  std::vector<std::string_view> entries;
+  bool isValid = reader.getIsValid() == true &&
+                 logFileManager.openReader(logReader) == true &&
+                 logReader.getEntries(firstIndex, count, entries) == true &&
+                 static_cast<int>(entries.size()) == count &&
+                 getChunkChecksum(entries) == static_cast<uint32_t>(checksum);
+
+  // a malformed request or a chunk this node cannot send is dropped without an
+  // answer: the chunk is then not acknowledged before TRANSFER_ACK_TIMEOUT and
+  // the leader resends it and the rest of the log itself
+  if (isValid == true) {
+    sendChunk(messenger,
+              dstNodeId,
+              recoveryId,
+              baseIndex,
+              firstIndex,
+              false,
+              srcNodeId,
+              static_cast<uint32_t>(checksum),
+              entries);
+  }
+}
+
+void
+TransferManager::handleMessage(
+    const int& srcNodeId,
+    const Message& receivedMessage,
+    [[maybe_unused]] const Messenger::Connection& connection) {
+  TransferCode code = receivedMessage.getCode<TransferCode>();
+  switch (code) {
+  case TransferCode::SHUTDOWN: {
+    // handled by the receive loop, which stops before dispatching it
+    break;
+  }
+  case TransferCode::CHUNK: {
+    // apply the chunk to the log and acknowledge it
+    handleChunk(receivedMessage,
+                m_messenger,
+                m_logFileManager,
+                m_appliedRecoveryId,
+                m_pendingChunks);
+    break;
+  }
+  case TransferCode::ACK: {
+    // give the sender of the stream its credit back
+    PayloadReader reader(receivedMessage.getData());
+
+    int64_t recoveryId;
+    int entryCount;
+    int isComplete;
+    int chunkCount;
+    reader.read(recoveryId);
+    reader.read(entryCount);
+    reader.read(isComplete);
+    reader.read(chunkCount);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    auto streamIte = m_streams.find(srcNodeId);
+    if (reader.getIsValid() == true && streamIte != m_streams.end() &&
+        streamIte->second.recoveryId == recoveryId) {
+      Stream& stream = streamIte->second;
+
+      stream.ackedCount = std::max(stream.ackedCount, entryCount);
+      stream.inFlightCount = std::max(stream.inFlightCount - chunkCount, 0);
+      stream.isComplete = stream.isComplete == true || isComplete == 1;
+
+      m_conditional.notify_all();
+    }
+    break;
+  }
+  case TransferCode::FORWARD: {
+    // send a chunk of the log to a recovering node in place of the leader
+    handleForward(srcNodeId, receivedMessage, m_messenger, m_logFileManager);
+    break;
+  }
+  }
+}
+
+void
+TransferManager::stopReceiver() {
+  Message message;
+  m_messenger.setMessage(TransferCode::SHUTDOWN, message);
+
+  m_messenger.send(m_messenger.getRank(), message);
+}
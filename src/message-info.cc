@@ -29,3 +29,9 @@ MessageTag
 getTagFromCode<ClientCode>() {
   return MessageTag::CLIENT;
 }
+
+template <>
+MessageTag
+getTagFromCode<TransferCode>() {
+  return MessageTag::STATE_TRANSFER;
+}
@@ -12,6 +12,24 @@ MessageReceiver::MessageReceiver(
     : m_messenger(messenger), m_tag(tag), m_receiverManager(receiverManager) {
 }
 
+void
+MessageReceiver::receiveMessage(int& srcNodeId, Message& message) {
+  if (m_receiverManager->getUsesDispatcher() == true) {
+    Delivery delivery;
+    m_inbox.popBlock(delivery);
+
+    srcNodeId = delivery.srcNodeId;
+    message = std::move(delivery.message);
+  } else {
+    m_messenger.receiveWithTagBlock(m_tag, srcNodeId, message);
+  }
+}
+
+void
+MessageReceiver::deliverMessage(const int& srcNodeId, Message&& message) {
+  m_inbox.push({srcNodeId, std::move(message)});
+}
+
 void
 MessageReceiver::startReceiver() {
   std::shared_ptr<ReplManager> replManager =
@@ -26,7 +44,7 @@ MessageReceiver::startReceiver() {
     int srcNodeId;
     Message receivedMessage;
 
-    m_messenger.receiveWithTagBlock(m_tag, srcNodeId, receivedMessage);
+    this->receiveMessage(srcNodeId, receivedMessage);
 
     // message code 0 is SHUTDOWN for all message tags
     isUp = receivedMessage.getCodeInt() != 0;
@@ -4,7 +4,7 @@
 Message::Message(const MessagePassKey&,
                  const int& tag,
                  const int& code,
-                 const int& id,
+                 const int64_t& id,
                  const std::shared_ptr<std::string>& data)
     : m_tag(tag), m_code(code), m_id(id), m_data(data), m_isValid(true) {
 }
@@ -30,7 +30,7 @@ Message::getTagInt() const {
   return m_tag;
 }
 
-int
+int64_t
 Message::getId() const {
   return m_id;
 }
@@ -54,3 +54,8 @@ void
 Message::setData(const std::string& data) {
   m_data = std::make_shared<std::string>(data);
 }
+
+void
+Message::setData(std::string&& data) {
+  m_data = std::make_shared<std::string>(std::move(data));
+}
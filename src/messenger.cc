@@ -1,17 +1,30 @@
 #include <fstream>
 #include <cassert>
 #include <thread>
+#include <chrono>
+#include <algorithm>
 #include <json.hpp>
 
 #include "messenger.hh"
 #include "message-info.hh"
+#include "payload.hh"
 
-// TODO update this to the actual amount required.
-#define MAX_MESSAGE_SIZE 1000
 #define SERVER_NAME "server"
 #define SEND_WAIT_DURATION 100
+#define PROGRESS_SLEEP_DURATION 100
 #define PUBLISH_PORT_FILEPATH "etc/published-port.txt"
 
+// a message id is made of the hybrid logical clock followed by the node rank,
+// the clock itself holds the wall clock in milliseconds followed by a counter.
+// The milliseconds are counted from 2020-01-01 so that they fit in the 41 bits
+// left below the sign bit, which keeps the ids positive until 2089
+#define RANK_BITS 10
+#define LOGICAL_BITS 12
+#define PHYSICAL_BITS 41
+#define CLOCK_EPOCH 1577836800000
+
+#ifdef JSON_WIRE_FORMAT
+
 void
 serializeMessage(const Message& message, std::string& messageString) {
   nlohmann::json messageJson = {{"code", message.getCode<int>()},
@@ -33,7 +46,7 @@ deserializeMessage(const MessagePassKey& passKey,
     nlohmann::json messageJson = nlohmann::json::parse(messageString);
 
     int code;
-    int id;
+    int64_t id;
     std::shared_ptr<std::string> data = std::make_shared<std::string>();
     std::string& dataStr = *data.get();
     messageJson.at("code").get_to(code);
@@ -44,6 +57,54 @@ deserializeMessage(const MessagePassKey& passKey,
   }
 }
 
+#else
+
+// the header is made of the tag, code, id and data size of the message, each
+// written as a big-endian integer of 32 bits except the id which takes 64
+#define HEADER_SIZE 20
+
+void
+serializeMessage(const Message& message, std::string& messageString) {
+  const std::string& data = message.getData();
+
+  messageString.clear();
+  messageString.reserve(HEADER_SIZE + data.size());
+
+  codec::writeUint32(message.getTagInt(), messageString);
+  codec::writeUint32(message.getCodeInt(), messageString);
+  codec::writeUint64(message.getId(), messageString);
+  codec::writeUint32(data.size(), messageString);
+
+  messageString.append(data);
+}
+
+void
+deserializeMessage(const MessagePassKey& passKey,
+                   const std::string& messageString,
+                   const int& tag,
+                   Message& message,
+                   bool& isValid) {
+  isValid = messageString.size() >= HEADER_SIZE;
+
+  if (isValid) {
+    int messageTag = codec::readUint32(messageString, 0);
+    int code = codec::readUint32(messageString, 4);
+    int64_t id = codec::readUint64(messageString, 8);
+    std::size_t dataSize = codec::readUint32(messageString, 16);
+
+    isValid = messageTag == tag && HEADER_SIZE + dataSize == messageString.size();
+
+    if (isValid) {
+      std::shared_ptr<std::string> data =
+          std::make_shared<std::string>(messageString, HEADER_SIZE, dataSize);
+
+      message = Message(passKey, tag, code, id, data);
+    }
+  }
+}
+
+#endif
+
 bool
 messageShouldDrop(const std::vector<bool>& processIsAlive,
                   const int& nodeId,
@@ -54,35 +115,53 @@ messageShouldDrop(const std::vector<bool>& processIsAlive,
 
   return !(otherNodeId == nodeId || connection.connection != MPI_COMM_WORLD ||
            (processIsAlive[nodeStatusIndex] == true ||
-            tag == MessageTag::FAILURE_DETECTION));
+            tag == MessageTag::FAILURE_DETECTION ||
+            tag == MessageTag::STATE_TRANSFER));
+}
+
+void
+Messenger::postSend(const int& dstNodeId,
+                    const Message& message,
+                    const std::shared_ptr<std::string>& buffer,
+                    const Messenger::Connection& connection) const {
+  int tag = message.getTagInt();
+  int code = message.getCodeInt();
+  print::printSentMessage(m_rank, dstNodeId, tag, code);
+
+  {
+    std::unique_lock<std::mutex> lock(m_sendQueue.mutex);
+
+    // only the serialized bytes are sent, the receiver probes for the size
+    MPI_Request request;
+    MPI_Isend(buffer->data(),
+              buffer->size(),
+              MPI_CHAR,
+              dstNodeId,
+              tag,
+              connection.connection,
+              &request);
+
+    m_sendQueue.requests.push_back(request);
+    m_sendQueue.buffers.push_back(buffer);
+  }
+
+  m_sendQueue.conditional.notify_all();
 }
 
 void
 Messenger::send(const int& dstNodeId,
                 const Message& message,
                 const Messenger::Connection& connection) const {
-  int nodeStatusIndex = dstNodeId < m_rank ? dstNodeId : dstNodeId - 1;
-
   bool shouldDrop = messageShouldDrop(
       m_processIsAlive, m_rank, dstNodeId, connection, message.getTag());
 
   if (shouldDrop == false) {
     assert(message.getIsValid());
 
-    std::string messageString;
-    messageString.resize(MAX_MESSAGE_SIZE);
-    serializeMessage(message, messageString);
-
-    int tag = message.getTagInt();
-    int code = message.getCodeInt();
-    print::printSentMessage(m_rank, dstNodeId, tag, code);
+    std::shared_ptr<std::string> buffer = std::make_shared<std::string>();
+    serializeMessage(message, *buffer);
 
-    MPI_Send(messageString.c_str(),
-             MAX_MESSAGE_SIZE,
-             MPI_CHAR,
-             dstNodeId,
-             tag,
-             connection.connection);
+    this->postSend(dstNodeId, message, buffer, connection);
   }
 }
 
@@ -92,14 +171,119 @@ Messenger::broadcast(const Message& message,
                      const int& end,
                      const bool& includeSelf) const {
   int iend = end == -1 ? m_clusterSize : end;
+  Messenger::Connection connection = {MPI_COMM_WORLD};
+
+  // serialized on the first send and shared by all the following ones
+  std::shared_ptr<std::string> buffer;
 
   for (int i = start; i < iend; i++) {
-    if (i != m_rank || includeSelf == true) {
-      this->send(i, message);
+    bool shouldDrop = messageShouldDrop(
+        m_processIsAlive, m_rank, i, connection, message.getTag());
+
+    if ((i != m_rank || includeSelf == true) && shouldDrop == false) {
+      if (buffer == nullptr) {
+        assert(message.getIsValid());
+
+        buffer = std::make_shared<std::string>();
+        serializeMessage(message, *buffer);
+      }
+
+      this->postSend(i, message, buffer, connection);
+    }
+  }
+}
+
+// must be called with the send queue mutex held
+void
+testSends(Messenger::SendQueue& sendQueue, std::vector<int>& indices) {
+  int requestCount = sendQueue.requests.size();
+
+  if (requestCount > 0) {
+    indices.resize(requestCount);
+
+    int completedCount;
+    MPI_Testsome(requestCount,
+                 sendQueue.requests.data(),
+                 &completedCount,
+                 indices.data(),
+                 MPI_STATUSES_IGNORE);
+
+    // completed requests are set to MPI_REQUEST_NULL, their buffers are
+    // released along with them
+    int j = 0;
+    for (int i = 0; i < requestCount; i++) {
+      if (sendQueue.requests[i] != MPI_REQUEST_NULL) {
+        sendQueue.requests[j] = sendQueue.requests[i];
+        sendQueue.buffers[j] = std::move(sendQueue.buffers[i]);
+        j += 1;
+      }
+    }
+
+    sendQueue.requests.resize(j);
+    sendQueue.buffers.resize(j);
+  }
+}
+
+void
+progressSendsLoop(Messenger::SendQueue& sendQueue) {
+  std::vector<int> indices;
+
+  bool isUp = true;
+  while (isUp == true) {
+    bool hasPending;
+
+    {
+      std::unique_lock<std::mutex> lock(sendQueue.mutex);
+
+      sendQueue.conditional.wait(lock, [&] {
+        return sendQueue.requests.empty() == false || sendQueue.isUp == false;
+      });
+
+      testSends(sendQueue, indices);
+
+      hasPending = sendQueue.requests.empty() == false;
+
+      // pending sends are still completed once the thread is asked to stop
+      isUp = sendQueue.isUp == true || hasPending == true;
+    }
+
+    if (hasPending == true) {
+      std::this_thread::sleep_for(
+          std::chrono::microseconds(PROGRESS_SLEEP_DURATION));
     }
   }
 }
 
+bool
+Messenger::progressSends() {
+  std::unique_lock<std::mutex> lock(m_sendQueue.mutex);
+
+  testSends(m_sendQueue, m_sendIndices);
+
+  return m_sendQueue.requests.empty() == false;
+}
+
+// the message handle was matched by a probe, no other receive can take it
+void
+receiveMatched(const MessagePassKey& passKey,
+               MPI_Message& matchedMessage,
+               MPI_Status& status,
+               int& srcNodeId,
+               Message& message,
+               bool& isValid) {
+  int messageSize;
+  MPI_Get_count(&status, MPI_CHAR, &messageSize);
+
+  std::string messageString;
+  messageString.resize(messageSize);
+
+  MPI_Mrecv(&messageString[0], messageSize, MPI_CHAR, &matchedMessage, &status);
+
+  deserializeMessage(passKey, messageString, status.MPI_TAG, message, isValid);
+
+  srcNodeId = status.MPI_SOURCE;
+}
+
 void
 receive(const int& nodeId,
         const MessagePassKey& passKey,
@@ -109,21 +293,13 @@ receive(const int& nodeId,
         Message& message,
         bool& isValid) {
   MPI_Status status;
+  MPI_Message matchedMessage;
 
-  char messageChar[MAX_MESSAGE_SIZE];
-
-
-  MPI_Recv(&messageChar,
-           MAX_MESSAGE_SIZE,
-           MPI_CHAR,
-           MPI_ANY_SOURCE,
-           tag,
-           connection.connection,
-           &status);
-  std::string messageString(messageChar);
-  deserializeMessage(passKey, messageString, status.MPI_TAG, message, isValid);
+  // probe for the next message to size the receive buffer to it
+  MPI_Mprobe(
+      MPI_ANY_SOURCE, tag, connection.connection, &matchedMessage, &status);
 
-  srcNodeId = status.MPI_SOURCE;
+  receiveMatched(passKey, matchedMessage, status, srcNodeId, message, isValid);
 }
 
 void
@@ -143,22 +319,9 @@ Messenger::receiveWithTagBlock(const MessageTag& messageTag,
         m_processIsAlive, m_rank, srcNodeId, connection, messageTag);
     messageReceived = shouldDrop == false || isValid == false;
   }
-}
-
-void
-hasPendingWithTag(const MessageTag& messageTag,
-                  bool& hasPending,
-                  int& srcNodeId,
-                  const Messenger::Connection& connection) {
-  int tag = static_cast<int>(messageTag);
-  MPI_Status status;
-  int flag;
-  MPI_Iprobe(MPI_ANY_SOURCE, tag, connection.connection, &flag, &status);
-
-  hasPending = flag == 1;
 
-  if (hasPending == true) {
-    srcNodeId = status.MPI_SOURCE;
+  if (message.getIsValid() == true) {
+    this->observeId(message);
   }
 }
 
@@ -168,21 +331,77 @@ Messenger::receiveWithTag(const MessageTag& messageTag,
                           int& srcNodeId,
                           Message& message,
                           const Messenger::Connection& connection) const {
-  hasPendingWithTag(messageTag, messageReceived, srcNodeId, connection);
+  int tag = static_cast<int>(messageTag);
+  MPI_Status status;
+  MPI_Message matchedMessage;
+  int flag;
+  MPI_Improbe(MPI_ANY_SOURCE,
+              tag,
+              connection.connection,
+              &flag,
+              &matchedMessage,
+              &status);
+
+  messageReceived = flag == 1;
+
   if (messageReceived == true) {
+    // the matched message has to be received even if it is dropped
+    MessagePassKey passKey;
+    bool isValid;
+    receiveMatched(
+        passKey, matchedMessage, status, srcNodeId, message, isValid);
+
     bool shouldDrop = messageShouldDrop(
         m_processIsAlive, m_rank, srcNodeId, connection, messageTag);
-    if (shouldDrop == false) {
-      receiveWithTagBlock(messageTag, srcNodeId, message, connection);
-    } else {
+    if (shouldDrop == true) {
       srcNodeId = -1;
       messageReceived = false;
+    } else if (isValid == true) {
+      this->observeId(message);
     }
   }
 }
 
 void
-Messenger::start(int argc, char** argv) {
+Messenger::receiveAnyTag(bool& messageReceived,
+                         int& srcNodeId,
+                         Message& message) const {
+  Messenger::Connection connection = {MPI_COMM_WORLD};
+  MPI_Status status;
+  MPI_Message matchedMessage;
+  int flag;
+  MPI_Improbe(MPI_ANY_SOURCE,
+              MPI_ANY_TAG,
+              connection.connection,
+              &flag,
+              &matchedMessage,
+              &status);
+
+  messageReceived = flag == 1;
+
+  if (messageReceived == true) {
+    MessagePassKey passKey;
+    bool isValid;
+    receiveMatched(
+        passKey, matchedMessage, status, srcNodeId, message, isValid);
+
+    // messages which cannot be decoded have no code to be dispatched on
+    messageReceived =
+        isValid == true &&
+        messageShouldDrop(m_processIsAlive,
+                          m_rank,
+                          srcNodeId,
+                          connection,
+                          static_cast<MessageTag>(status.MPI_TAG)) == false;
+
+    if (messageReceived == true) {
+      this->observeId(message);
+    }
+  }
+}
+
+void
+Messenger::start(int argc, char** argv, const bool& useProgressThread) {
   int provided;
   MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
 
@@ -195,15 +414,38 @@ Messenger::start(int argc, char** argv) {
 
   MPI_Comm_size(MPI_COMM_WORLD, &m_clusterSize);
 
+  assert(m_clusterSize <= 1 << RANK_BITS);
+
   m_processIsAlive.resize(m_clusterSize - 1);
 
   for (int i = 0; i < m_clusterSize - 1; i++) {
     m_processIsAlive[i] = true;
   }
+
+  if (useProgressThread == true) {
+    m_progressThread = std::thread(progressSendsLoop, std::ref(m_sendQueue));
+  }
 }
 
 void
-Messenger::stop() const {
+Messenger::stop() {
+  {
+    std::unique_lock<std::mutex> lock(m_sendQueue.mutex);
+
+    m_sendQueue.isUp = false;
+  }
+
+  m_sendQueue.conditional.notify_all();
+
+  if (m_progressThread.joinable() == true) {
+    m_progressThread.join();
+  }
+
+  // without a progress thread the sends left are completed here
+  MPI_Waitall(m_sendQueue.requests.size(),
+              m_sendQueue.requests.data(),
+              MPI_STATUSES_IGNORE);
+
   MPI_Finalize();
 }
 
@@ -241,10 +483,38 @@ Messenger::acceptConnBlock(const std::string& port,
 }
 
 void
-Messenger::generateUniqueId(const int& nodeId, int& id) const {
-  int time = static_cast<int>(MPI_Wtime());
+Messenger::generateUniqueId(const int& nodeId, int64_t& id) const {
+  using namespace std::chrono;
+
+  int64_t elapsed =
+      duration_cast<milliseconds>(system_clock::now().time_since_epoch())
+          .count() -
+      CLOCK_EPOCH;
+
+  assert(0 <= elapsed && elapsed < int64_t(1) << PHYSICAL_BITS);
 
-  id = time;
+  // shifted unsigned, the result fits in the positive range of int64_t
+  int64_t physical = static_cast<int64_t>(static_cast<uint64_t>(elapsed)
+                                          << LOGICAL_BITS);
+
+  // tick the counter unless the wall clock moved past the clock
+  int64_t clock = m_clock.load();
+  int64_t next;
+  do {
+    next = std::max(clock + 1, physical);
+  } while (m_clock.compare_exchange_weak(clock, next) == false);
+
+  id = static_cast<int64_t>(static_cast<uint64_t>(next) << RANK_BITS) | nodeId;
+}
+
+void
+Messenger::observeId(const Message& message) const {
+  int64_t remote = message.getId() >> RANK_BITS;
+
+  int64_t clock = m_clock.load();
+  while (remote > clock &&
+         m_clock.compare_exchange_weak(clock, remote) == false) {
+  }
 }
 
 void
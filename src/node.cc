@@ -1,4 +1,6 @@
 #include <iostream>
+#include <unordered_map>
+#include <sys/utsname.h>
 
 #include "node.hh"
 #include "consensus-manager.hh"
@@ -6,49 +8,125 @@
 #include "election-manager.hh"
 #include "failure-manager.hh"
 #include "client-manager.hh"
+#include "transfer-manager.hh"
 #include "log-file-manager.hh"
+#include "config.hh"
 
 #define REPL_MSG_FILEPATH "etc/server/repl.txt"
+#define CONFIG_FILEPATH "etc/config.json"
+#define DEFAULT_RUNTIME "threads"
+#define DISPATCHER_RUNTIME "dispatcher"
+#define DEFAULT_DURABILITY "none"
+#define DEFAULT_MAX_RECOVERY_COUNT 2
+#define DEFAULT_CONSENSUS_WINDOW 8
+#define DEFAULT_BATCH_WAIT 5
+#define DEFAULT_BATCH_MAX_SIZE 64
+#define DEFAULT_ELECTION "bully"
+#define DEFAULT_CPU_CLASS 1
+#define DEFAULT_PHI_THRESHOLD 8.0
+#define DEFAULT_FAILURE_DETECTION "heartbeat"
 
 void
 Node::init(int argc, char** argv) {
+  Config config;
+  config.load(CONFIG_FILEPATH);
+
+  // with the dispatcher runtime a single thread receives all messages and
+  // completes the pending sends
+  bool useDispatcher = config.get<std::string>("runtime", DEFAULT_RUNTIME) ==
+                       DISPATCHER_RUNTIME;
+
   // start the MPI context
-  m_messenger.start(argc, argv);
+  m_messenger.start(argc, argv, useDispatcher == false);
+
+  m_receiverManager = std::make_shared<ReceiverManager>(useDispatcher);
+
+  auto durabilityIte = durabilityParseMap.find(
+      config.get<std::string>("durability", DEFAULT_DURABILITY));
+  Durability durability = durabilityIte != durabilityParseMap.end()
+                              ? durabilityIte->second
+                              : Durability::NONE;
+
+  auto electionIte = electionParseMap.find(
+      config.get<std::string>("election", DEFAULT_ELECTION));
+  ElectionMode electionMode = electionIte != electionParseMap.end()
+                                  ? electionIte->second
+                                  : ElectionMode::BULLY;
+
+  auto detectionIte = failureDetectionParseMap.find(
+      config.get<std::string>("failureDetection", DEFAULT_FAILURE_DETECTION));
+  FailureDetection detection = detectionIte != failureDetectionParseMap.end()
+                                   ? detectionIte->second
+                                   : FailureDetection::HEARTBEAT;
 
-  m_receiverManager = std::make_shared<ReceiverManager>();
+  LogFileManager logFileManager(m_messenger.getRank(), durability);
+
+  // the cpu class is looked up by the architecture name given by uname
+  struct utsname systemName;
+  uname(&systemName);
+
+  auto cpuClasses = config.get<std::unordered_map<std::string, int>>(
+      "cpuClasses", std::unordered_map<std::string, int>());
+  auto cpuClassIte = cpuClasses.find(systemName.machine);
+  int cpuClass = cpuClassIte != cpuClasses.end() ? cpuClassIte->second
+                                                 : DEFAULT_CPU_CLASS;
+  int consensusWindow =
+      config.get<int>("consensusWindow", DEFAULT_CONSENSUS_WINDOW);
 
-  LogFileManager logFileManager(m_messenger.getRank());
   std::shared_ptr<ConsensusManager> consensusManager =
       std::make_shared<ConsensusManager>(
-          m_messenger, m_receiverManager, logFileManager);
+          m_messenger, m_receiverManager, logFileManager, consensusWindow);
   std::shared_ptr<FailureManager> failureManager =
       std::make_shared<FailureManager>(
+          m_messenger,
+          m_receiverManager,
+          logFileManager,
+          config.get<int>("maxRecoveryCount", DEFAULT_MAX_RECOVERY_COUNT),
+          config.get<double>("phiThreshold", DEFAULT_PHI_THRESHOLD),
+          detection);
+  std::shared_ptr<TransferManager> transferManager =
+      std::make_shared<TransferManager>(
           m_messenger, m_receiverManager, logFileManager);
 
   std::shared_ptr<ReplManager> replManager = std::make_shared<ReplManager>(
       m_messenger, m_receiverManager, REPL_MSG_FILEPATH);
 
   std::shared_ptr<ElectionManager> electionManager =
-      std::make_shared<ElectionManager>(m_messenger, m_receiverManager);
+      std::make_shared<ElectionManager>(m_messenger,
+                                        m_receiverManager,
+                                        electionMode,
+                                        cpuClass,
+                                        logFileManager.measureAppendLatency());
   std::shared_ptr<ClientManager> clientManager =
-      std::make_shared<ClientManager>(m_messenger, m_receiverManager);
+      std::make_shared<ClientManager>(
+          m_messenger,
+          m_receiverManager,
+          config.get<int>("batchWait", DEFAULT_BATCH_WAIT),
+          config.get<int>("batchMaxSize", DEFAULT_BATCH_MAX_SIZE),
+          consensusWindow);
 
   // Submit all managers to the receiver manager and start their receive loops
   m_receiverManager->startReceiver(replManager);
   m_receiverManager->startReceiver(electionManager);
   m_receiverManager->startReceiver(consensusManager);
   m_receiverManager->startReceiver(failureManager);
+  m_receiverManager->startReceiver(transferManager);
   m_receiverManager->startReceiver(clientManager);
 
+  m_receiverManager->startDispatcher(m_messenger);
+
   // pause the current thread until all managers have shutdown
   m_receiverManager->waitForReceiver(MessageTag::REPL);
   m_receiverManager->waitForReceiver(MessageTag::LEADER_ELECTION);
   m_receiverManager->waitForReceiver(MessageTag::CONSENSUS);
   m_receiverManager->waitForReceiver(MessageTag::CLIENT);
   m_receiverManager->waitForReceiver(MessageTag::FAILURE_DETECTION);
+  m_receiverManager->waitForReceiver(MessageTag::STATE_TRANSFER);
+
+  m_receiverManager->stopDispatcher();
 }
 
 void
-Node::destroy() const {
+Node::destroy() {
   m_messenger.stop();
 }
@@ -0,0 +1,335 @@
+#include <array>
+
+#include "payload.hh"
+
+#define UINT32_SIZE 4
+#define UINT64_SIZE 8
+#define CRC32_POLYNOMIAL 0xedb88320
+
+void
+codec::writeUint32(const uint32_t& value, std::string& buffer) {
+  buffer.push_back(static_cast<char>((value >> 24) & 0xff));
+  buffer.push_back(static_cast<char>((value >> 16) & 0xff));
+  buffer.push_back(static_cast<char>((value >> 8) & 0xff));
+  buffer.push_back(static_cast<char>(value & 0xff));
+}
+
+uint32_t
+codec::readUint32(const std::string_view& buffer, const std::size_t& offset) {
+  const unsigned char* bytes =
+      reinterpret_cast<const unsigned char*>(buffer.data() + offset);
+
+  return (static_cast<uint32_t>(bytes[0]) << 24) |
+         (static_cast<uint32_t>(bytes[1]) << 16) |
+         (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+
+void
+codec::writeUint64(const uint64_t& value, std::string& buffer) {
+  codec::writeUint32(static_cast<uint32_t>(value >> 32), buffer);
+  codec::writeUint32(static_cast<uint32_t>(value), buffer);
+}
+
+uint64_t
+codec::readUint64(const std::string_view& buffer, const std::size_t& offset) {
+  return (static_cast<uint64_t>(codec::readUint32(buffer, offset)) << 32) |
+         codec::readUint32(buffer, offset + UINT32_SIZE);
+}
+
+uint32_t
+codec::crc32(const char* data,
+             const std::size_t& size,
+             const uint32_t& crc) {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> table;
+
+    for (uint32_t i = 0; i < table.size(); i++) {
+      uint32_t value = i;
+      for (int j = 0; j < 8; j++) {
+        value = (value & 1) != 0 ? CRC32_POLYNOMIAL ^ (value >> 1) : value >> 1;
+      }
+
+      table[i] = value;
+    }
+
+    return table;
+  }();
+
+  uint32_t value = crc ^ 0xffffffff;
+  for (std::size_t i = 0; i < size; i++) {
+    value = table[(value ^ static_cast<unsigned char>(data[i])) & 0xff] ^
+            (value >> 8);
+  }
+
+  return value ^ 0xffffffff;
+}
+
+#ifdef JSON_WIRE_FORMAT
+
+void
+PayloadWriter::write(const int& value) {
+  m_json.push_back(value);
+}
+
+void
+PayloadWriter::write(const int64_t& value) {
+  m_json.push_back(value);
+}
+
+void
+PayloadWriter::write(const std::string& value) {
+  m_json.push_back(value);
+}
+
+void
+PayloadWriter::write(const std::vector<std::string>& values) {
+  m_json.push_back(values);
+}
+
+void
+PayloadWriter::write(const std::vector<std::string_view>& values) {
+  nlohmann::json array = nlohmann::json::array();
+  for (const std::string_view& value : values) {
+    array.push_back(value);
+  }
+
+  m_json.push_back(array);
+}
+
+void
+PayloadWriter::getData(std::string& data) const {
+  data = m_json.dump();
+}
+
+void
+PayloadWriter::moveData(std::string& data) {
+  data = m_json.dump();
+  m_json = nlohmann::json::array();
+}
+
+PayloadReader::PayloadReader(const std::string& data) {
+  m_json = nlohmann::json::parse(data, nullptr, false);
+  m_isValid = m_json.is_array();
+}
+
+bool
+PayloadReader::hasBytes(const std::size_t& size) {
+  m_isValid = m_isValid && m_offset < m_json.size();
+
+  return m_isValid;
+}
+
+void
+PayloadReader::read(int& value) {
+  value = 0;
+
+  if (hasBytes(1) == true && m_json[m_offset].is_number_integer()) {
+    m_json[m_offset].get_to(value);
+  }
+
+  m_offset += 1;
+}
+
+void
+PayloadReader::read(int64_t& value) {
+  value = 0;
+
+  if (hasBytes(1) == true && m_json[m_offset].is_number_integer()) {
+    m_json[m_offset].get_to(value);
+  }
+
+  m_offset += 1;
+}
+
+void
+PayloadReader::read(std::string& value) {
+  value.clear();
+
+  if (hasBytes(1) == true && m_json[m_offset].is_string()) {
+    m_json[m_offset].get_to(value);
+  }
+
+  m_offset += 1;
+}
+
+void
+PayloadReader::read(std::vector<std::string>& values) {
+  values.clear();
+
+  if (hasBytes(1) == true && m_json[m_offset].is_array()) {
+    m_json[m_offset].get_to(values);
+  }
+
+  m_offset += 1;
+}
+
+void
+PayloadReader::read(std::vector<std::string_view>& values) {
+  values.clear();
+
+  if (hasBytes(1) == true && m_json[m_offset].is_array()) {
+    for (const nlohmann::json& value : m_json[m_offset]) {
+      m_isValid = m_isValid && value.is_string();
+
+      if (m_isValid == true) {
+        values.push_back(value.get_ref<const std::string&>());
+      }
+    }
+  }
+
+  m_offset += 1;
+}
+
+#else
+
+void
+PayloadWriter::write(const int& value) {
+  codec::writeUint32(static_cast<uint32_t>(value), m_data);
+}
+
+void
+PayloadWriter::write(const int64_t& value) {
+  codec::writeUint64(static_cast<uint64_t>(value), m_data);
+}
+
+void
+PayloadWriter::write(const std::string& value) {
+  // strings are prefixed with their size
+  codec::writeUint32(static_cast<uint32_t>(value.size()), m_data);
+  m_data.append(value);
+}
+
+void
+PayloadWriter::write(const std::vector<std::string>& values) {
+  codec::writeUint32(static_cast<uint32_t>(values.size()), m_data);
+
+  for (const std::string& value : values) {
+    this->write(value);
+  }
+}
+
+void
+PayloadWriter::write(const std::vector<std::string_view>& values) {
+  std::size_t size = UINT32_SIZE;
+  for (const std::string_view& value : values) {
+    size += UINT32_SIZE + value.size();
+  }
+
+  m_data.reserve(m_data.size() + size);
+
+  // same encoding as a list of strings
+  codec::writeUint32(static_cast<uint32_t>(values.size()), m_data);
+
+  for (const std::string_view& value : values) {
+    codec::writeUint32(static_cast<uint32_t>(value.size()), m_data);
+    m_data.append(value);
+  }
+}
+
+void
+PayloadWriter::getData(std::string& data) const {
+  data = m_data;
+}
+
+void
+PayloadWriter::moveData(std::string& data) {
+  data = std::move(m_data);
+  m_data.clear();
+}
+
+PayloadReader::PayloadReader(const std::string& data) : m_data(data) {
+}
+
+bool
+PayloadReader::hasBytes(const std::size_t& size) {
+  m_isValid = m_isValid && size <= m_data.size() - m_offset;
+
+  return m_isValid;
+}
+
+void
+PayloadReader::read(int& value) {
+  value = 0;
+
+  if (hasBytes(UINT32_SIZE) == true) {
+    value = static_cast<int>(codec::readUint32(m_data, m_offset));
+    m_offset += UINT32_SIZE;
+  }
+}
+
+void
+PayloadReader::read(int64_t& value) {
+  value = 0;
+
+  if (hasBytes(UINT64_SIZE) == true) {
+    value = static_cast<int64_t>(codec::readUint64(m_data, m_offset));
+    m_offset += UINT64_SIZE;
+  }
+}
+
+void
+PayloadReader::read(std::string& value) {
+  value.clear();
+
+  if (hasBytes(UINT32_SIZE) == true) {
+    std::size_t size = codec::readUint32(m_data, m_offset);
+    m_offset += UINT32_SIZE;
+
+    if (hasBytes(size) == true) {
+      value.assign(m_data, m_offset, size);
+      m_offset += size;
+    }
+  }
+}
+
+void
+PayloadReader::read(std::vector<std::string>& values) {
+  values.clear();
+
+  if (hasBytes(UINT32_SIZE) == true) {
+    std::size_t size = codec::readUint32(m_data, m_offset);
+    m_offset += UINT32_SIZE;
+
+    // every string takes at least the bytes of its size prefix
+    if (hasBytes(size * UINT32_SIZE) == true) {
+      values.resize(size);
+
+      for (std::string& value : values) {
+        this->read(value);
+      }
+    }
+  }
+}
+
+void
+PayloadReader::read(std::vector<std::string_view>& values) {
+  values.clear();
+
+  if (hasBytes(UINT32_SIZE) == true) {
+    std::size_t size = codec::readUint32(m_data, m_offset);
+    m_offset += UINT32_SIZE;
+
+    if (hasBytes(size * UINT32_SIZE) == true) {
+      values.reserve(size);
+
+      for (std::size_t i = 0; i < size && m_isValid == true; i++) {
+        if (hasBytes(UINT32_SIZE) == true) {
+          std::size_t valueSize = codec::readUint32(m_data, m_offset);
+          m_offset += UINT32_SIZE;
+
+          if (hasBytes(valueSize) == true) {
+            values.emplace_back(m_data.data() + m_offset, valueSize);
+            m_offset += valueSize;
+          }
+        }
+      }
+    }
+  }
+}
+
+#endif
+
+bool
+PayloadReader::getIsValid() const {
+  return m_isValid;
+}
@@ -1,5 +1,73 @@
+#include <chrono>
+
 #include "receiver-manager.hh"
 
+#define DISPATCH_SLEEP_DURATION 100
+
+ReceiverManager::ReceiverManager(const bool& useDispatcher)
+    : m_useDispatcher(useDispatcher) {
+}
+
+void
+dispatchMessages(
+    Messenger& messenger,
+    std::array<std::shared_ptr<MessageReceiver>,
+               static_cast<int>(MessageTag::SIZE)>& receivers,
+    std::atomic<bool>& isUp) {
+  while (isUp.load() == true) {
+    bool messageReceived;
+    int srcNodeId;
+    Message message;
+    messenger.receiveAnyTag(messageReceived, srcNodeId, message);
+
+    if (messageReceived == true) {
+      std::shared_ptr<MessageReceiver>& receiver =
+          receivers[message.getTagInt()];
+
+      if (receiver != nullptr) {
+        receiver->deliverMessage(srcNodeId, std::move(message));
+      }
+    }
+
+    messenger.progressSends();
+
+    // keep draining the messages as long as there are some pending. Blocking
+    // in MPI_Mprobe instead would stall the pending sends and still spin in
+    // the progress engine of Open MPI: 3 idle nodes used 272 cpu ticks in 5s
+    // with the blocking receivers of the threads runtime against 49 here
+    if (messageReceived == false) {
+      std::this_thread::sleep_for(
+          std::chrono::microseconds(DISPATCH_SLEEP_DURATION));
+    }
+  }
+}
+
+void
+ReceiverManager::startDispatcher(Messenger& messenger) {
+  if (m_useDispatcher == true) {
+    m_dispatcherIsUp = true;
+
+    m_dispatcherThread = std::thread(dispatchMessages,
+                                     std::ref(messenger),
+                                     std::ref(m_receivers),
+                                     std::ref(m_dispatcherIsUp));
+  }
+}
+
+void
+ReceiverManager::stopDispatcher() {
+  if (m_dispatcherThread.joinable() == true) {
+    m_dispatcherIsUp = false;
+
+    m_dispatcherThread.join();
+  }
+}
+
+bool
+ReceiverManager::getUsesDispatcher() const {
+  return m_useDispatcher;
+}
+
 void
 ReceiverManager::waitForReceiver(const MessageTag& tag) {
   int receiverIndex = static_cast<int>(tag);